@@ -0,0 +1,50 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 기존 트리 n개에 m개짜리 무작위 배치를 넣을 때 rbtree_insert 반복과 rbtree_insert_batch 비교
+// 사용법: ./bench-batch [n]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  static const size_t ratios[] = {1000, 100, 10, 4, 2, 1}; // 배치 크기 = n / ratio
+  key_t *base = malloc(n * sizeof(key_t));
+  key_t *batch = malloc(n * sizeof(key_t));
+  if (base == NULL || batch == NULL)
+    return 1;
+
+  uint64_t seed = 42;
+  for (size_t i = 0; i < n; i++)
+    base[i] = (key_t)(bench_rand(&seed) % (n * 4));
+
+  printf("impl,n,m,ns_per_key\n");
+  for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++)
+  {
+    size_t m = n / ratios[r];
+    for (size_t i = 0; i < m; i++)
+      batch[i] = (key_t)(bench_rand(&seed) % (n * 4));
+
+    rbtree *t = new_rbtree();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, base[i]);
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < m; i++)
+      rbtree_insert(t, batch[i]);
+    printf("insert,%zu,%zu,%.1f\n", n, m, (double)(bench_now_ns() - start) / m);
+    delete_rbtree(t);
+
+    t = new_rbtree();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, base[i]);
+    start = bench_now_ns();
+    rbtree_insert_batch(t, batch, m); // 정렬 시간 포함
+    printf("insert_batch,%zu,%zu,%.1f\n", n, m, (double)(bench_now_ns() - start) / m);
+    delete_rbtree(t);
+  }
+
+  free(batch);
+  free(base);
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 오래 삽입 / 삭제를 반복해 노드가 흩어진 트리에서 rbtree_compact 전후의 rbtree_find 지연 비교
+// 사용법: ./bench-compact [n] [churn] [lookups]
+static double bench_find(const rbtree *t, const key_t *keys, size_t lookups, size_t *found)
+{
+  *found = 0;
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    *found += rbtree_find(t, keys[i]) != NULL;
+  return (double)(bench_now_ns() - start) / lookups;
+}
+
+// 살아 있는 키 중 하나를 지우고 새 키를 넣는 것을 rounds번 반복 (free list를 통해 노드가 섞임)
+static void bench_churn(rbtree *t, key_t *live, size_t n, size_t rounds, uint64_t *seed)
+{
+  for (size_t r = 0; r < rounds; r++)
+  {
+    size_t i = bench_rand(seed) % n;
+    rbtree_erase_key(t, live[i]);
+    live[i] = (key_t)(bench_rand(seed) % (n * 2));
+    rbtree_insert(t, live[i]);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  size_t churn = argc > 2 ? strtoul(argv[2], NULL, 10) : 8000000;
+  size_t lookups = argc > 3 ? strtoul(argv[3], NULL, 10) : 2000000;
+  uint64_t seed = 42;
+
+  key_t *live = malloc(n * sizeof(key_t));
+  key_t *keys = malloc(lookups * sizeof(key_t));
+  if (live == NULL || keys == NULL)
+    return 1;
+
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+  {
+    live[i] = (key_t)(bench_rand(&seed) % (n * 2));
+    rbtree_insert(t, live[i]);
+  }
+  for (size_t i = 0; i < lookups; i++)
+    keys[i] = (key_t)(bench_rand(&seed) % (n * 2));
+
+  printf("phase,n,churn,lookups,ns_per_find,compact_ms,found\n");
+
+  size_t found;
+  double ns = bench_find(t, keys, lookups, &found);
+  printf("fresh,%zu,0,%zu,%.1f,,%zu\n", n, lookups, ns, found);
+
+  bench_churn(t, live, n, churn, &seed);
+  ns = bench_find(t, keys, lookups, &found);
+  printf("churned,%zu,%zu,%zu,%.1f,,%zu\n", n, churn, lookups, ns, found);
+
+  uint64_t start = bench_now_ns();
+  if (rbtree_compact(t) != 0)
+    return 1;
+  double compact_ms = (double)(bench_now_ns() - start) / 1e6;
+  ns = bench_find(t, keys, lookups, &found);
+  printf("compacted,%zu,%zu,%zu,%.1f,%.1f,%zu\n", n, churn, lookups, ns, compact_ms, found);
+
+  // 옮긴 뒤에도 계속 수정하면 새 노드부터 다시 흩어짐
+  bench_churn(t, live, n, churn / 4, &seed);
+  ns = bench_find(t, keys, lookups, &found);
+  printf("churned_again,%zu,%zu,%zu,%.1f,,%zu\n", n, churn / 4, lookups, ns, found);
+
+  free(keys);
+  free(live);
+  delete_rbtree(t);
+  return 0;
+}
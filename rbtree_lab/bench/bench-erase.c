@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 만료 시각을 키로 쓰는 TTL 트리: [0, n) 범위의 무작위 시각 n개
+static rbtree *make_tree(size_t n, uint64_t *seed)
+{
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, (key_t)(bench_rand(seed) % n));
+  return t;
+}
+
+// 하나씩 지우는 방식: lower_bound에서 시작해서 hi 전까지 erase
+static size_t erase_each(rbtree *t, key_t lo, key_t hi)
+{
+  size_t removed = 0;
+  node_t *cur = rbtree_lower_bound(t, lo);
+  while (cur != NULL && cur->key < hi)
+  {
+    node_t *next = rbtree_next(t, cur);
+    rbtree_erase(t, cur);
+    cur = next;
+    removed++;
+  }
+  return removed;
+}
+
+// 범위 삭제를 하나씩 지우는 방식과 비교 (만료 sweep처럼 앞쪽 구간, 그리고 중간 구간)
+// 사용법: ./bench-erase [n]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  static const size_t fractions[] = {10000, 100, 10, 2}; // 지울 범위 = 키 범위 / fraction
+  printf("op,impl,n,k,ms\n");
+
+  for (size_t f = 0; f < sizeof(fractions) / sizeof(fractions[0]); f++)
+  {
+    const key_t width = (key_t)(n / fractions[f]);
+    for (int sweep = 0; sweep < 2; sweep++) // 0: 앞쪽 만료 구간, 1: 중간 구간
+    {
+      const key_t lo = sweep == 0 ? -1 : (key_t)(n / 2);
+      const key_t hi = lo + width;
+      const char *op = sweep == 0 ? "sweep" : "middle";
+
+      uint64_t seed = 42;
+      rbtree *t = make_tree(n, &seed);
+      uint64_t start = bench_now_ns();
+      size_t k = erase_each(t, lo, hi);
+      printf("%s,each,%zu,%zu,%.3f\n", op, n, k, (double)(bench_now_ns() - start) / 1e6);
+      delete_rbtree(t);
+
+      seed = 42;
+      t = make_tree(n, &seed);
+      start = bench_now_ns();
+      k = rbtree_erase_range(t, lo, hi);
+      printf("%s,erase_range,%zu,%zu,%.3f\n", op, n, k, (double)(bench_now_ns() - start) / 1e6);
+      delete_rbtree(t);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// rbtree_find 반복과 rbtree_find_batch의 처리량 비교 (트리가 LLC보다 훨씬 클 때 차이가 큼)
+// 사용법: ./bench-find-batch [n] [lookups]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 4000000;
+  static const size_t batches[] = {16, 256, 4096}; // 한 번에 넘기는 키 수
+  uint64_t seed = 42;
+
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, (key_t)(bench_rand(&seed) % (n * 2)));
+
+  key_t *keys = malloc(lookups * sizeof(key_t));
+  node_t **out = malloc(lookups * sizeof(node_t *));
+  if (keys == NULL || out == NULL)
+    return 1;
+  for (size_t i = 0; i < lookups; i++)
+  {
+    keys[i] = (key_t)(bench_rand(&seed) % (n * 2));
+    out[i] = NULL; // 결과 배열의 페이지 폴트가 첫 측정에 들어가지 않도록 미리 건드림
+  }
+
+  printf("impl,batch,n,lookups,ns_per_op,mops,found\n");
+
+  size_t found = 0;
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    found += (out[i] = rbtree_find(t, keys[i])) != NULL;
+  uint64_t ns = bench_now_ns() - start;
+  printf("find,1,%zu,%zu,%.1f,%.2f,%zu\n", n, lookups, (double)ns / lookups, bench_ops_per_sec(lookups, ns) / 1e6, found);
+
+  for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+  {
+    found = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < lookups; i += batches[b])
+      found += rbtree_find_batch(t, keys + i, lookups - i < batches[b] ? lookups - i : batches[b], out + i);
+    ns = bench_now_ns() - start;
+    printf("find_batch,%zu,%zu,%zu,%.1f,%.2f,%zu\n", batches[b], n, lookups, (double)ns / lookups,
+           bench_ops_per_sec(lookups, ns) / 1e6, found);
+  }
+
+  free(out);
+  free(keys);
+  delete_rbtree(t);
+  return 0;
+}
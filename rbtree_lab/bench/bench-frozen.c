@@ -0,0 +1,65 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_frozen.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__AVX2__)
+#define SIMD_NAME "avx2"
+#elif defined(__SSE2__)
+#define SIMD_NAME "sse2"
+#else
+#define SIMD_NAME "scalar"
+#endif
+
+// 트리 크기를 L1에 들어가는 크기부터 DRAM까지 늘려가며 rbtree_find와 스냅샷 탐색 비교
+// 사용법: ./bench-frozen [max_n] [lookups]
+int main(int argc, char *argv[])
+{
+  size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 16000000;
+  size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 2000000;
+  key_t *keys = malloc(lookups * sizeof(key_t));
+  if (keys == NULL)
+    return 1;
+
+  printf("simd,n,tree_bytes,frozen_bytes,freeze_ms,find_ns_per_op,frozen_find_ns_per_op,speedup\n");
+  for (size_t n = 1000; n <= max_n; n *= 4)
+  {
+    uint64_t seed = 42;
+    rbtree *t = new_rbtree();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, (key_t)(bench_rand(&seed) % (n * 2)));
+    for (size_t i = 0; i < lookups; i++)
+      keys[i] = (key_t)(bench_rand(&seed) % (n * 2));
+
+    uint64_t start = bench_now_ns();
+    frozen_rbtree *f = rbtree_freeze(t);
+    uint64_t freeze_ns = bench_now_ns() - start;
+    if (f == NULL)
+      return 1;
+
+    size_t found = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < lookups; i++)
+      found += rbtree_find(t, keys[i]) != NULL;
+    uint64_t find_ns = bench_now_ns() - start;
+
+    size_t frozen_found = 0;
+    start = bench_now_ns();
+    for (size_t i = 0; i < lookups; i++)
+      frozen_found += frozen_rbtree_find(f, keys[i]) != FROZEN_RBTREE_NPOS;
+    uint64_t frozen_ns = bench_now_ns() - start;
+    if (found != frozen_found)
+      return 1;
+
+    size_t frozen_bytes = (f->offsets[f->height - 1] + FROZEN_RBTREE_B) * sizeof(key_t); // 맨 위 층은 블록 하나
+    printf("%s,%zu,%zu,%zu,%.3f,%.1f,%.1f,%.2f\n", SIMD_NAME, n, n * sizeof(node_t), frozen_bytes, (double)freeze_ns / 1e6,
+           (double)find_ns / lookups, (double)frozen_ns / lookups, (double)find_ns / (double)frozen_ns);
+
+    delete_frozen_rbtree(f);
+    delete_rbtree(t);
+  }
+
+  free(keys);
+  return 0;
+}
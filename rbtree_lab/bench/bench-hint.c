@@ -0,0 +1,55 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+enum { STREAM_SORTED, STREAM_NEARLY, STREAM_RANDOM };
+static const char *stream_names[] = {"sorted", "nearly_sorted", "random"};
+
+// 정렬 / 거의 정렬 / 무작위 키 스트림 생성
+static void make_stream(key_t *keys, size_t n, int kind, uint64_t seed)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    if (kind == STREAM_SORTED)
+      keys[i] = (key_t)i;
+    else if (kind == STREAM_NEARLY) // 1%의 키는 최대 1000만큼 과거로 튐
+      keys[i] = (key_t)i - (bench_rand(&seed) % 100 == 0 ? (key_t)(bench_rand(&seed) % 1000) : 0);
+    else
+      keys[i] = (key_t)(bench_rand(&seed) % (n * 4));
+  }
+}
+
+// rbtree_insert와 직전 노드를 hint로 쓰는 rbtree_insert_hint 비교
+// 사용법: ./bench-hint [n]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+  key_t *keys = malloc(n * sizeof(key_t));
+  if (keys == NULL)
+    return 1;
+
+  printf("stream,impl,n,ns_per_insert\n");
+  for (int kind = STREAM_SORTED; kind <= STREAM_RANDOM; kind++)
+  {
+    make_stream(keys, n, kind, 42);
+
+    rbtree *t = new_rbtree();
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, keys[i]);
+    printf("%s,insert,%zu,%.1f\n", stream_names[kind], n, (double)(bench_now_ns() - start) / n);
+    delete_rbtree(t);
+
+    t = new_rbtree();
+    node_t *hint = NULL;
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      hint = rbtree_insert_hint(t, hint, keys[i]);
+    printf("%s,insert_hint,%zu,%.1f\n", stream_names[kind], n, (double)(bench_now_ns() - start) / n);
+    delete_rbtree(t);
+  }
+
+  free(keys);
+  return 0;
+}
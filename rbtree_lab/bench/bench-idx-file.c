@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_idx.h"
+#include "rbtree_snapshot.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// 파일에 매핑된 인덱스 트리를 다시 열어 바로 탐색하는 시간과 스냅샷(rbtree_load)으로 다시 만드는 시간 비교
+// 파일은 페이지 캐시에 있는 상태로 잼
+// 사용법: ./bench-idx-file [n] [lookups] [dir]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+  size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+  const char *dir = argc > 3 ? argv[3] : "/tmp";
+  char idx_path[4096], snap_path[4096];
+  snprintf(idx_path, sizeof(idx_path), "%s/bench-idx-file.idx", dir);
+  snprintf(snap_path, sizeof(snap_path), "%s/bench-idx-file.rbt", dir);
+  unlink(idx_path);
+  uint64_t seed = 42;
+
+  // 파일에 직접 삽입 (파일이 늘어나며 다시 매핑됨)
+  idx_rbtree *t = idx_rbtree_open(idx_path, 0);
+  if (t == NULL)
+    return 1;
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < n; i++)
+    if (idx_rbtree_insert(t, (key_t)(bench_rand(&seed) % (n * 2))) == IDX_RBTREE_NIL)
+      return 1;
+  uint64_t insert_ns = bench_now_ns() - start;
+  start = bench_now_ns();
+  if (idx_rbtree_sync(t) != 0)
+    return 1;
+  uint64_t sync_ns = bench_now_ns() - start;
+  size_t file_bytes = t->map_size;
+  delete_idx_rbtree(t);
+
+  // 같은 키로 스냅샷 파일 준비
+  seed = 42;
+  rbtree *p = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(p, (key_t)(bench_rand(&seed) % (n * 2)));
+  int fd = open(snap_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || rbtree_save(p, fd) != 0)
+    return 1;
+  delete_rbtree(p);
+
+  key_t *keys = malloc(lookups * sizeof(key_t));
+  if (keys == NULL)
+    return 1;
+  for (size_t i = 0; i < lookups; i++)
+    keys[i] = (key_t)(bench_rand(&seed) % (n * 2));
+
+  printf("mode,n,file_bytes,insert_ms,sync_ms,open_ms,find_ns_per_op,found\n");
+
+  // 다시 열기: 매핑만 하므로 크기와 무관
+  start = bench_now_ns();
+  t = idx_rbtree_open(idx_path, 1);
+  uint64_t open_ns = bench_now_ns() - start;
+  if (t == NULL)
+    return 1;
+  size_t found = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    found += idx_rbtree_find(t, keys[i]) != IDX_RBTREE_NIL;
+  uint64_t find_ns = bench_now_ns() - start;
+  printf("idx_file,%zu,%zu,%.1f,%.1f,%.3f,%.1f,%zu\n", n, file_bytes, insert_ns / 1e6, sync_ns / 1e6, open_ns / 1e6,
+         (double)find_ns / lookups, found);
+  delete_idx_rbtree(t);
+
+  // 스냅샷에서 다시 만들기
+  start = bench_now_ns();
+  p = rbtree_load(fd);
+  open_ns = bench_now_ns() - start;
+  if (p == NULL)
+    return 1;
+  found = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    found += rbtree_find(p, keys[i]) != NULL;
+  find_ns = bench_now_ns() - start;
+  printf("snapshot_load,%zu,%zu,,,%.3f,%.1f,%zu\n", n, (size_t)lseek(fd, 0, SEEK_END), open_ns / 1e6,
+         (double)find_ns / lookups, found);
+  delete_rbtree(p);
+
+  close(fd);
+  unlink(snap_path);
+  unlink(idx_path);
+  free(keys);
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_idx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+// 최대 RSS (바이트)
+static size_t peak_rss(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (size_t)ru.ru_maxrss * 1024;
+}
+
+// 포인터 기반 트리와 32비트 인덱스 기반 트리의 insert/find 처리량과 RSS 비교
+// RSS를 따로 재기 위해 레이아웃마다 프로세스를 나눠서 실행
+// 사용법: ./bench-idx [ptr|idx] [n] [lookups]
+int main(int argc, char *argv[])
+{
+  int use_idx = argc > 1 && strcmp(argv[1], "idx") == 0;
+  size_t n = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+  size_t lookups = argc > 3 ? strtoul(argv[3], NULL, 10) : 1000000;
+  uint64_t seed = 42, found = 0;
+  uint64_t insert_ns, find_ns;
+  size_t rss_before = peak_rss();
+
+  if (use_idx)
+  {
+    idx_rbtree *t = new_idx_rbtree();
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      idx_rbtree_insert(t, (key_t)bench_rand(&seed));
+    insert_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < lookups; i++)
+      found += idx_rbtree_find(t, (key_t)bench_rand(&seed)) != IDX_RBTREE_NIL;
+    find_ns = bench_now_ns() - start;
+    delete_idx_rbtree(t);
+  }
+  else
+  {
+    rbtree *t = new_rbtree();
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, (key_t)bench_rand(&seed));
+    insert_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (size_t i = 0; i < lookups; i++)
+      found += rbtree_find(t, (key_t)bench_rand(&seed)) != NULL;
+    find_ns = bench_now_ns() - start;
+    delete_rbtree(t);
+  }
+
+  printf("layout,n,insert_ops_per_sec,find_ops_per_sec,rss_bytes_per_key,found\n");
+  printf("%s,%zu,%.0f,%.0f,%.1f,%llu\n", use_idx ? "idx32" : "pointer", n,
+         bench_ops_per_sec(n, insert_ns), bench_ops_per_sec(lookups, find_ns),
+         (double)(peak_rss() - rss_before) / n, (unsigned long long)found);
+  return 0;
+}
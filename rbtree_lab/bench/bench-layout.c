@@ -0,0 +1,63 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#ifdef RBTREE_COMPACT
+#define LAYOUT_NAME "compact"
+#else
+#define LAYOUT_NAME "default"
+#endif
+
+#ifdef RBTREE_ORDER_STAT
+#define LAYOUT_AUG "+ostat"
+#else
+#define LAYOUT_AUG ""
+#endif
+
+// 최대 RSS (바이트)
+static size_t peak_rss(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (size_t)ru.ru_maxrss * 1024;
+}
+
+// 노드 레이아웃별 키당 메모리와 탐색 지연 시간 측정
+// 사용법: ./bench-layout [n] [lookups]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  size_t lookups = argc > 2 ? strtoul(argv[2], NULL, 10) : 2000000;
+  uint64_t seed = 42;
+
+  size_t rss_before = peak_rss();
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, (key_t)bench_rand(&seed));
+  size_t rss_after = peak_rss();
+
+  // 삽입한 키를 다시 만들어서 임의 순서로 탐색 (키 배열은 RSS 측정 뒤에 할당)
+  key_t *keys = malloc(n * sizeof(key_t));
+  if (keys == NULL)
+    return 1;
+  seed = 42;
+  for (size_t i = 0; i < n; i++)
+    keys[i] = (key_t)bench_rand(&seed);
+
+  uint64_t found = 0;
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    found += rbtree_find(t, keys[bench_rand(&seed) % n]) != NULL;
+  uint64_t find_ns = bench_now_ns() - start;
+
+  printf("layout,node_bytes,n,rss_bytes_per_key,find_ns_per_op,found\n");
+  printf("%s%s,%zu,%zu,%.1f,%.1f,%llu\n", LAYOUT_NAME, LAYOUT_AUG, sizeof(node_t), n,
+         (double)(rss_after - rss_before) / n, (double)find_ns / lookups,
+         (unsigned long long)found);
+
+  free(keys);
+  delete_rbtree(t);
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#ifdef RBTREE_MULTISET
+#define MODE_NAME "multiset"
+#else
+#define MODE_NAME "duplicate"
+#endif
+
+// 최대 RSS (바이트)
+static size_t peak_rss(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (size_t)ru.ru_maxrss * 1024;
+}
+
+// 순위 1..universe에 대한 Zipf(s) 누적 분포 (cdf[i]는 순위 i + 1까지의 확률)
+static double *zipf_cdf(size_t universe, double s)
+{
+  double *cdf = malloc(universe * sizeof(double));
+  if (cdf == NULL)
+    return NULL;
+
+  double sum = 0;
+  for (size_t i = 0; i < universe; i++)
+  {
+    sum += 1.0 / pow((double)(i + 1), s);
+    cdf[i] = sum;
+  }
+  for (size_t i = 0; i < universe; i++)
+    cdf[i] /= sum;
+  return cdf;
+}
+
+// 누적 분포에서 이진 탐색으로 순위 하나를 뽑아 키로 사용 (순위를 섞어서 키 순서와 빈도가 무관하게)
+static key_t zipf_key(const double *cdf, size_t universe, uint64_t *seed)
+{
+  double u = (double)(bench_rand(seed) >> 11) / 9007199254740992.0; // [0, 1)
+  size_t lo = 0, hi = universe - 1;
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cdf[mid] < u)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (key_t)((lo * 2654435761u) % universe);
+}
+
+// Zipf 분포 키에서 중복 키를 노드로 따로 두는 방식과 개수로 합치는 방식(RBTREE_MULTISET)의 메모리와 탐색 지연 시간 비교
+// 사용법: ./bench-multiset [n] [universe] [s] [lookups]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  size_t universe = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+  double s = argc > 3 ? strtod(argv[3], NULL) : 1.0;
+  size_t lookups = argc > 4 ? strtoul(argv[4], NULL, 10) : 2000000;
+  uint64_t seed = 42;
+
+  double *cdf = zipf_cdf(universe, s);
+  key_t *keys = malloc(n * sizeof(key_t));
+  if (cdf == NULL || keys == NULL)
+    return 1;
+  for (size_t i = 0; i < n; i++)
+    keys[i] = zipf_key(cdf, universe, &seed);
+
+  size_t rss_before = peak_rss();
+  rbtree *t = new_rbtree();
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, keys[i]);
+  uint64_t insert_ns = bench_now_ns() - start;
+  size_t rss_after = peak_rss();
+
+  size_t nodes = 0;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p))
+    nodes++;
+
+  // 조회도 같은 분포에서 뽑음 (자주 나오는 키일수록 자주 찾음)
+  uint64_t found = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < lookups; i++)
+    found += rbtree_find(t, zipf_key(cdf, universe, &seed)) != NULL;
+  uint64_t find_ns = bench_now_ns() - start;
+
+  printf("mode,n,universe,s,nodes,node_bytes,tree_bytes,rss_bytes_per_key,insert_ns_per_op,find_ns_per_op,found\n");
+  printf("%s,%zu,%zu,%.2f,%zu,%zu,%zu,%.1f,%.1f,%.1f,%llu\n", MODE_NAME, n, universe, s, nodes, sizeof(node_t),
+         nodes * sizeof(node_t), (double)(rss_after - rss_before) / n, (double)insert_ns / n,
+         (double)find_ns / lookups, (unsigned long long)found);
+
+  delete_rbtree(t);
+  free(keys);
+  free(cdf);
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_workers.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// 오름차순 정렬용 비교 함수
+static int cmp_key(const void *a, const void *b)
+{
+  key_t x = *(const key_t *)a, y = *(const key_t *)b;
+  return (x > y) - (x < y);
+}
+
+// bulk build / union / to_array의 강한 확장성(strong scaling): 같은 입력을 스레드 1 ~ N개로 처리
+// 사용법: ./bench-parallel [n] [max_threads]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned int max_threads = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 10) : (unsigned int)(cpus > 0 ? cpus : 1);
+  key_t *arr = malloc(n * sizeof(key_t));
+  key_t *half = malloc(n / 2 * sizeof(key_t));
+  key_t *out = malloc(n * sizeof(key_t));
+  if (arr == NULL || half == NULL || out == NULL)
+    return 1;
+
+  uint64_t seed = 42;
+  for (size_t i = 0; i < n; i++)
+    arr[i] = (key_t)(bench_rand(&seed) % (n * 4));
+  qsort(arr, n, sizeof(key_t), cmp_key);
+  for (size_t i = 0; i < n / 2; i++)
+    half[i] = (key_t)(bench_rand(&seed) % (n * 4));
+  qsort(half, n / 2, sizeof(key_t), cmp_key);
+
+  double base[3] = {0};
+  printf("op,threads,n,ms,speedup\n");
+  for (unsigned int threads = 1;; threads *= 2) // 1, 2, 4, ..., max_threads
+  {
+    if (threads > max_threads)
+      threads = max_threads;
+    rbtree_workers *w = rbtree_workers_new(threads);
+    if (w == NULL)
+      return 1;
+    double ms[3];
+
+    uint64_t start = bench_now_ns();
+    rbtree *t = rbtree_from_sorted_par(w, arr, n);
+    ms[0] = (double)(bench_now_ns() - start) / 1e6;
+
+    start = bench_now_ns();
+    rbtree_to_array_par(w, t, out, n);
+    ms[1] = (double)(bench_now_ns() - start) / 1e6;
+
+    rbtree *u = rbtree_from_sorted(half, n / 2);
+    start = bench_now_ns();
+    rbtree_union_par(w, t, u); // u는 다른 풀이므로 t의 풀로 옮기는 시간도 포함
+    ms[2] = (double)(bench_now_ns() - start) / 1e6;
+    delete_rbtree(t);
+
+    static const char *names[] = {"from_sorted", "to_array", "union"};
+    for (int op = 0; op < 3; op++)
+    {
+      if (threads == 1)
+        base[op] = ms[op];
+      printf("%s,%u,%zu,%.3f,%.2f\n", names[op], threads, n, ms[op], base[op] / ms[op]);
+    }
+    rbtree_workers_delete(w);
+    if (threads == max_threads)
+      break;
+  }
+
+  free(out);
+  free(half);
+  free(arr);
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef RBTREE_NO_POOL
+#define ALLOCATOR "malloc"
+#else
+#define ALLOCATOR "pool"
+#endif
+
+// 노드 할당 방식(pool / malloc)에 따른 insert, erase 처리량 측정
+// 사용법: ./bench-pool [n] [churn]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  size_t churn = argc > 2 ? strtoul(argv[2], NULL, 10) : 4 * n;
+  uint64_t seed = 42;
+
+  node_t **nodes = malloc(n * sizeof(node_t *));
+  if (nodes == NULL)
+    return 1;
+
+  rbtree *t = new_rbtree();
+
+  // 1. 랜덤 키 n개 삽입
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < n; i++)
+    nodes[i] = rbtree_insert(t, (key_t)bench_rand(&seed));
+  uint64_t insert_ns = bench_now_ns() - start;
+
+  // 2. 임의의 노드를 지우고 새 키를 넣는 churn 작업
+  start = bench_now_ns();
+  for (size_t i = 0; i < churn; i++)
+  {
+    size_t victim = bench_rand(&seed) % n;
+    rbtree_erase(t, nodes[victim]);
+    nodes[victim] = rbtree_insert(t, (key_t)bench_rand(&seed));
+  }
+  uint64_t churn_ns = bench_now_ns() - start;
+
+  // 3. 트리 전체 해제
+  start = bench_now_ns();
+  delete_rbtree(t);
+  uint64_t delete_ns = bench_now_ns() - start;
+
+  printf("allocator,n,insert_ops_per_sec,churn_ops_per_sec,delete_ms\n");
+  printf("%s,%zu,%.0f,%.0f,%.3f\n", ALLOCATOR, n,
+         bench_ops_per_sec(n, insert_ns),
+         bench_ops_per_sec(2 * churn, churn_ns),
+         delete_ns / 1e6);
+
+  free(nodes);
+  return 0;
+}
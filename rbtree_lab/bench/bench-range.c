@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 비교용: 트리 전체를 export 한 뒤 [lo, hi) 구간을 골라내는 기존 방식
+static size_t range_by_export(const rbtree *t, key_t *all, size_t n, key_t lo, key_t hi, key_t *out, size_t cap)
+{
+  size_t count = 0;
+  rbtree_to_array(t, all, n);
+  for (size_t i = 0; i < n && count < cap; i++)
+    if (all[i] >= lo && all[i] < hi)
+      out[count++] = all[i];
+  return count;
+}
+
+// 좁은 / 넓은 범위 질의 처리량 측정
+// 사용법: ./bench-range [n] [queries]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  size_t queries = argc > 2 ? strtoul(argv[2], NULL, 10) : 100000;
+  // 키는 [0, n * 16) 에서 뽑으므로 폭 w인 구간에는 평균 w / 16개의 키가 들어감
+  const key_t widths[] = {16, 1024, 65536};
+  uint64_t seed = 42;
+
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, (key_t)(bench_rand(&seed) % (n * 16)));
+
+  key_t *all = malloc(n * sizeof(key_t));
+  key_t *out = malloc(n * sizeof(key_t));
+  if (all == NULL || out == NULL)
+    return 1;
+
+  printf("impl,n,width,queries,keys_per_query,ns_per_query\n");
+  for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+  {
+    size_t total = 0;
+    uint64_t start = bench_now_ns();
+    for (size_t q = 0; q < queries; q++)
+    {
+      key_t lo = (key_t)(bench_rand(&seed) % (n * 16));
+      total += rbtree_range(t, lo, lo + widths[w], out, n);
+    }
+    uint64_t ns = bench_now_ns() - start;
+    printf("rbtree_range,%zu,%d,%zu,%.1f,%.1f\n", n, widths[w], queries,
+           (double)total / queries, (double)ns / queries);
+  }
+
+  // export 방식은 질의 하나가 O(n)이므로 적은 수만 측정
+  size_t slow_queries = queries / 1000 + 1;
+  size_t total = 0;
+  uint64_t start = bench_now_ns();
+  for (size_t q = 0; q < slow_queries; q++)
+  {
+    key_t lo = (key_t)(bench_rand(&seed) % (n * 16));
+    total += range_by_export(t, all, n, lo, lo + widths[0], out, n);
+  }
+  uint64_t ns = bench_now_ns() - start;
+  printf("to_array_scan,%zu,%d,%zu,%.1f,%.1f\n", n, widths[0], slow_queries,
+         (double)total / slow_queries, (double)ns / slow_queries);
+
+  free(out);
+  free(all);
+  delete_rbtree(t);
+  return 0;
+}
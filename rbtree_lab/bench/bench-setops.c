@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 무작위 키 n개로 t와 풀을 공유하는 트리 생성 (t가 NULL이면 새 풀)
+static rbtree *make_tree(rbtree *t, size_t n, key_t range, uint64_t *seed)
+{
+  rbtree *u = t == NULL ? new_rbtree() : new_rbtree_shared(t);
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(u, (key_t)(bench_rand(seed) % range));
+  return u;
+}
+
+// 비교용: 두 트리를 배열로 export 해서 병합한 뒤 rbtree_from_sorted로 다시 만드는 기존 방식
+static rbtree *union_by_export(rbtree *a, rbtree *b, key_t *buf_a, key_t *buf_b, key_t *out)
+{
+  size_t na = rbtree_size(a), nb = rbtree_size(b), i = 0, j = 0, k = 0;
+  rbtree_to_array(a, buf_a, na);
+  rbtree_to_array(b, buf_b, nb);
+  while (i < na || j < nb)
+  {
+    if (j == nb || (i < na && buf_a[i] < buf_b[j]))
+      out[k++] = buf_a[i++];
+    else if (i == na || buf_b[j] < buf_a[i])
+      out[k++] = buf_b[j++];
+    else // 양쪽에 있는 키는 하나만
+    {
+      out[k++] = buf_a[i++];
+      j++;
+    }
+  }
+  delete_rbtree(a);
+  delete_rbtree(b);
+  return rbtree_from_sorted(out, k);
+}
+
+// split / union을 export 후 재구성하는 방식과 비교
+// 사용법: ./bench-setops [n]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  static const size_t ratios[] = {1, 10, 1000}; // 작은 쪽 트리 크기 = n / ratio
+  const key_t range = (key_t)(n * 4);
+  key_t *buf_a = malloc(n * sizeof(key_t));
+  key_t *buf_b = malloc(n * sizeof(key_t));
+  key_t *out = malloc(2 * n * sizeof(key_t));
+  if (buf_a == NULL || buf_b == NULL || out == NULL)
+    return 1;
+
+  uint64_t seed = 42;
+  printf("op,impl,n,m,ms\n");
+
+  // split: 중간 키로 나누기
+  rbtree *t = make_tree(NULL, n, range, &seed);
+  uint64_t start = bench_now_ns();
+  rbtree *lo, *hi;
+  rbtree_split(t, range / 2, &lo, &hi);
+  printf("split,split,%zu,%zu,%.3f\n", n, n, (double)(bench_now_ns() - start) / 1e6);
+  delete_rbtree(lo);
+  delete_rbtree(hi);
+
+  t = make_tree(NULL, n, range, &seed);
+  start = bench_now_ns();
+  size_t count = rbtree_size(t), cut = 0;
+  rbtree_to_array(t, buf_a, count);
+  while (cut < count && buf_a[cut] < range / 2)
+    cut++;
+  lo = rbtree_from_sorted(buf_a, cut);
+  hi = rbtree_from_sorted(buf_a + cut, count - cut);
+  delete_rbtree(t);
+  printf("split,export,%zu,%zu,%.3f\n", n, n, (double)(bench_now_ns() - start) / 1e6);
+  delete_rbtree(lo);
+  delete_rbtree(hi);
+
+  // union: 같은 풀의 트리끼리 합치기
+  for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); r++)
+  {
+    size_t m = n / ratios[r];
+
+    rbtree *a = make_tree(NULL, n, range, &seed);
+    rbtree *b = make_tree(a, m, range, &seed);
+    start = bench_now_ns();
+    rbtree_union(a, b);
+    printf("union,union,%zu,%zu,%.3f\n", n, m, (double)(bench_now_ns() - start) / 1e6);
+    delete_rbtree(a);
+
+    a = make_tree(NULL, n, range, &seed);
+    b = make_tree(a, m, range, &seed);
+    start = bench_now_ns();
+    a = union_by_export(a, b, buf_a, buf_b, out);
+    printf("union,export,%zu,%zu,%.3f\n", n, m, (double)(bench_now_ns() - start) / 1e6);
+    delete_rbtree(a);
+  }
+
+  free(out);
+  free(buf_b);
+  free(buf_a);
+  return 0;
+}
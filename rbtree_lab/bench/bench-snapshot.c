@@ -0,0 +1,63 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_snapshot.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// rbtree_save / rbtree_load 처리량(GB/s)과 키를 하나씩 다시 넣는 워밍업 비교
+// 파일은 페이지 캐시에 있는 상태로 재므로 디스크 속도가 아니라 직렬화 자체의 비용
+// 사용법: ./bench-snapshot [n] [path]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+  const char *path = argc > 2 ? argv[2] : "/tmp/bench-snapshot.rbt";
+  uint64_t seed = 42;
+
+  key_t *keys = malloc(n * sizeof(key_t));
+  if (keys == NULL)
+    return 1;
+  for (size_t i = 0; i < n; i++)
+    keys[i] = (key_t)(bench_rand(&seed) % (n * 2));
+
+  uint64_t start = bench_now_ns();
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, keys[i]);
+  uint64_t insert_ns = bench_now_ns() - start;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return 1;
+  start = bench_now_ns();
+  if (rbtree_save(t, fd) != 0)
+    return 1;
+  uint64_t save_ns = bench_now_ns() - start;
+  size_t bytes = (size_t)lseek(fd, 0, SEEK_END);
+
+  start = bench_now_ns();
+  rbtree *u = rbtree_load(fd);
+  uint64_t load_ns = bench_now_ns() - start;
+  if (u == NULL || rbtree_size(u) != n)
+    return 1;
+
+  // 불러온 트리는 노드가 키 순서에 가깝게 연속으로 놓여 있어 다시 저장할 때 캐시 미스가 적음
+  if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+    return 1;
+  start = bench_now_ns();
+  if (rbtree_save(u, fd) != 0)
+    return 1;
+  uint64_t resave_ns = bench_now_ns() - start;
+
+  printf("n,file_bytes,insert_ms,save_ms,save_gb_per_sec,load_ms,load_gb_per_sec,resave_ms,resave_gb_per_sec\n");
+  printf("%zu,%zu,%.1f,%.1f,%.2f,%.1f,%.2f,%.1f,%.2f\n", n, bytes, insert_ns / 1e6, save_ns / 1e6, (double)bytes / save_ns,
+         load_ns / 1e6, (double)bytes / load_ns, resave_ns / 1e6, (double)bytes / resave_ns);
+
+  close(fd);
+  unlink(path);
+  delete_rbtree(u);
+  delete_rbtree(t);
+  free(keys);
+  return 0;
+}
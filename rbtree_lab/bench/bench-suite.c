@@ -0,0 +1,210 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 연산 x 키 분포 x 트리 크기 전체를 재는 회귀 측정용 벤치마크
+// 사용법: ./bench-suite [max_n] [ops]  (max_n: 가장 큰 트리 크기, ops: 단계마다 반복할 연산 수)
+// 출력: op,dist,n,ops,ns_per_op,ops_per_sec,peak_rss_bytes (CSV, 시드 고정)
+// 크기마다 프로세스를 나눠서 실행하므로 peak_rss_bytes는 그 크기까지의 최대 RSS
+
+#define SUITE_SEED 42
+#define SUITE_ZIPF_THETA 0.99
+
+typedef enum { DIST_SEQ, DIST_RANDOM, DIST_ZIPF } suite_dist;
+
+static const char *dist_names[] = {"seq", "random", "zipf"};
+
+static volatile key_t suite_sink; // 결과를 여기 써서 측정 루프가 최적화로 지워지지 않게 함
+
+// 트리에 넣는 키는 모두 짝수이고, 홀수 키는 항상 없는 키
+typedef struct {
+  suite_dist dist;
+  size_t n;
+  uint64_t seed;
+  size_t next;          // DIST_SEQ에서 다음 순번
+  double zetan, eta;    // Zipf 표본 추출 상수 (Gray et al., O(1) 메모리)
+} suite_keys;
+
+// 1..n 순위에 대한 zeta(n, theta) = sum 1 / i^theta
+static double zeta(size_t n, double theta)
+{
+  double sum = 0;
+  for (size_t i = 1; i <= n; i++)
+    sum += 1.0 / pow((double)i, theta);
+  return sum;
+}
+
+static void suite_keys_init(suite_keys *g, suite_dist dist, size_t n)
+{
+  memset(g, 0, sizeof(*g));
+  g->dist = dist;
+  g->n = n;
+  g->seed = SUITE_SEED;
+  if (dist == DIST_ZIPF)
+  {
+    g->zetan = zeta(n, SUITE_ZIPF_THETA);
+    g->eta = (1 - pow(2.0 / n, 1 - SUITE_ZIPF_THETA)) / (1 - zeta(2, SUITE_ZIPF_THETA) / g->zetan);
+  }
+}
+
+// 분포에서 [0, n) 사이 값을 하나 뽑음 (Zipf는 순위를 섞어서 자주 나오는 키가 키 공간에 흩어지게)
+static size_t suite_draw(suite_keys *g)
+{
+  switch (g->dist)
+  {
+  case DIST_SEQ:
+    return g->next++ % g->n;
+  case DIST_RANDOM:
+    return bench_rand(&g->seed) % g->n;
+  default:
+  {
+    double u = (double)(bench_rand(&g->seed) >> 11) / 9007199254740992.0; // [0, 1)
+    double uz = u * g->zetan;
+    size_t rank;
+    if (uz < 1.0)
+      rank = 0;
+    else if (uz < 1.0 + pow(0.5, SUITE_ZIPF_THETA))
+      rank = 1;
+    else
+      rank = (size_t)(g->n * pow(g->eta * u - g->eta + 1, 1.0 / (1 - SUITE_ZIPF_THETA)));
+    if (rank >= g->n)
+      rank = g->n - 1;
+    return (size_t)((rank * 2654435761ull) % g->n);
+  }
+  }
+}
+
+static key_t suite_key(suite_keys *g)
+{
+  return (key_t)(2 * suite_draw(g));
+}
+
+static void suite_row(const char *op, suite_dist dist, size_t n, size_t ops, uint64_t ns)
+{
+  printf("%s,%s,%zu,%zu,%.1f,%.0f,%zu\n", op, dist_names[dist], n, ops, ops == 0 ? 0.0 : (double)ns / ops,
+         bench_ops_per_sec(ops, ns), bench_peak_rss());
+  fflush(stdout);
+}
+
+// 한 분포, 한 크기에 대해 모든 연산을 순서대로 잼 (앞 단계가 만든 트리를 이어서 사용)
+static int suite_run(suite_dist dist, size_t n, size_t ops)
+{
+  suite_keys g;
+  suite_keys_init(&g, dist, n);
+  key_t *keys = malloc(n * sizeof(key_t)); // 넣은 키 (find hit, erase에서 사용)
+  key_t *probe = malloc(ops * sizeof(key_t));
+  key_t *out = malloc(n * sizeof(key_t));
+  rbtree *t = new_rbtree();
+  if (keys == NULL || probe == NULL || out == NULL || t == NULL)
+    return -1;
+  for (size_t i = 0; i < n; i++)
+    keys[i] = suite_key(&g);
+
+  // insert: 빈 트리에 n개
+  uint64_t start = bench_now_ns();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, keys[i]);
+  suite_row("insert", dist, n, n, bench_now_ns() - start);
+
+  // find_hit: 넣은 키 중 임의로
+  uint64_t seed = SUITE_SEED + 1;
+  for (size_t i = 0; i < ops; i++)
+    probe[i] = keys[bench_rand(&seed) % n];
+  size_t found = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < ops; i++)
+    found += rbtree_find(t, probe[i]) != NULL;
+  suite_row("find_hit", dist, n, ops, bench_now_ns() - start);
+  if (found != ops)
+    return -1;
+
+  // find_miss: 같은 분포의 홀수 키
+  for (size_t i = 0; i < ops; i++)
+    probe[i] = suite_key(&g) + 1;
+  found = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < ops; i++)
+    found += rbtree_find(t, probe[i]) != NULL;
+  suite_row("find_miss", dist, n, ops, bench_now_ns() - start);
+  if (found != 0)
+    return -1;
+
+  // minmax: rbtree_min, rbtree_max를 번갈아
+  uint64_t sum = 0;
+  start = bench_now_ns();
+  for (size_t i = 0; i < ops; i++)
+    sum += (i & 1 ? rbtree_max(t) : rbtree_min(t))->key;
+  suite_row("minmax", dist, n, ops, bench_now_ns() - start);
+
+  // to_array: 키 ops개 이상을 내보낼 때까지 반복, 키 하나당 시간
+  size_t reps = ops / n > 0 ? ops / n : 1;
+  start = bench_now_ns();
+  for (size_t r = 0; r < reps; r++)
+    rbtree_to_array(t, out, n);
+  suite_row("to_array", dist, n, reps * n, bench_now_ns() - start);
+  sum += out[n - 1];
+
+  // mixed: find 80%, insert 10%, erase 10% (트리 크기는 거의 그대로)
+  for (size_t i = 0; i < ops; i++)
+    probe[i] = suite_key(&g);
+  start = bench_now_ns();
+  for (size_t i = 0; i < ops; i++)
+  {
+    uint64_t r = bench_rand(&seed) % 10;
+    if (r == 0)
+      rbtree_insert(t, probe[i]);
+    else if (r == 1)
+      rbtree_erase_key(t, probe[i]);
+    else
+      found += rbtree_find(t, probe[i]) != NULL;
+  }
+  suite_row("mixed", dist, n, ops, bench_now_ns() - start);
+
+  // erase: 넣은 순서대로 최대 ops개 (없는 키도 한 번 찾는 비용은 같음)
+  size_t erases = n < ops ? n : ops;
+  start = bench_now_ns();
+  for (size_t i = 0; i < erases; i++)
+    rbtree_erase_key(t, keys[i]);
+  suite_row("erase", dist, n, erases, bench_now_ns() - start);
+
+  delete_rbtree(t);
+  free(out);
+  free(probe);
+  free(keys);
+  suite_sink = (key_t)(sum + found);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t max_n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  size_t ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000000;
+
+  printf("op,dist,n,ops,ns_per_op,ops_per_sec,peak_rss_bytes\n");
+  fflush(stdout);
+  for (size_t n = 1000; n <= max_n; n *= 10)
+  {
+    for (int d = DIST_SEQ; d <= DIST_ZIPF; d++)
+    {
+      // 크기마다 새 프로세스에서 재서 앞 크기의 RSS와 힙 상태가 섞이지 않게 함
+      pid_t pid = fork();
+      if (pid < 0)
+        return 1;
+      if (pid == 0)
+        _exit(suite_run((suite_dist)d, n, ops) == 0 ? 0 : 1);
+
+      int status;
+      if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      {
+        fprintf(stderr, "bench-suite: %s n=%zu failed\n", dist_names[d], n);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
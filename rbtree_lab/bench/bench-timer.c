@@ -0,0 +1,47 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 타이머 큐 워크로드: 임의의 마감 시각을 넣고 가장 이른 것을 꺼내는 작업 반복
+// 사용법: ./bench-timer [n] [ops]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+  size_t ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 5000000;
+
+  // 지연 범위를 큐 크기에 비례하게 잡아서 now가 연산당 평균 10 정도씩만 증가 (int 오버플로 방지)
+  uint64_t span = (uint64_t)n * 20 + 1;
+
+  printf("impl,queue_size,ops,ns_per_insert_pop\n");
+
+  for (int cached = 0; cached <= 1; cached++)
+  {
+    uint64_t seed = 42;
+    key_t now = 0;
+    rbtree *t = new_rbtree();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, now + (key_t)(bench_rand(&seed) % span));
+
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < ops; i++)
+    {
+      key_t deadline;
+      if (cached) // 캐시된 최소 노드를 바로 삭제
+        rbtree_pop_min(t, &deadline);
+      else // 비교용: 매번 루트에서 왼쪽 끝까지 내려가서 찾은 뒤 삭제
+      {
+        node_t *p = rbtree_min_subtree(t, t->root);
+        deadline = p->key;
+        rbtree_erase(t, p);
+      }
+      now = deadline;
+      rbtree_insert(t, now + (key_t)(bench_rand(&seed) % span));
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    printf("%s,%zu,%zu,%.1f\n", cached ? "pop_min" : "walk_min_erase", n, ops, (double)ns / ops);
+    delete_rbtree(t);
+  }
+  return 0;
+}
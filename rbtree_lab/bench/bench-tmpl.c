@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "rbtree.h"
+#include "rbtree_tmpl.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+struct rec {
+  uint64_t id;
+  uint64_t payload;
+};
+
+struct pair_key {
+  uint32_t hi;
+  uint32_t lo;
+};
+
+static inline int cmp_int(int a, int b)
+{
+  return (a > b) - (a < b);
+}
+
+static inline int cmp_u64(uint64_t a, uint64_t b)
+{
+  return (a > b) - (a < b);
+}
+
+static inline int cmp_pair(struct pair_key a, struct pair_key b)
+{
+  if (a.hi != b.hi)
+    return a.hi < b.hi ? -1 : 1;
+  return (a.lo > b.lo) - (a.lo < b.lo);
+}
+
+RBTREE_DEFINE(intmap, int, struct rec, cmp_int)
+RBTREE_DEFINE(u64map, uint64_t, struct rec, cmp_u64)
+RBTREE_DEFINE(pairmap, struct pair_key, struct rec, cmp_pair)
+
+static void report(const char *impl, size_t n, uint64_t insert_ns, uint64_t find_ns, uint64_t found)
+{
+  printf("%s,%zu,%.1f,%.1f,%llu\n", impl, n, (double)insert_ns / n, (double)find_ns / n,
+         (unsigned long long)found);
+}
+
+// 같은 난수 키를 넣고 찾을 때 타입별 특수화 트리와 기본 트리 비교
+#define BENCH_TMPL(name, impl, n, make_key)                  \
+  do                                                         \
+  {                                                          \
+    uint64_t seed = 42, found = 0;                           \
+    name *t = name##_new();                                  \
+    uint64_t start = bench_now_ns();                         \
+    for (size_t i = 0; i < (n); i++)                         \
+    {                                                        \
+      uint64_t r = bench_rand(&seed);                        \
+      name##_insert(t, make_key(r), (struct rec){r, i});     \
+    }                                                        \
+    uint64_t insert_ns = bench_now_ns() - start;             \
+    seed = 42;                                               \
+    start = bench_now_ns();                                  \
+    for (size_t i = 0; i < (n); i++)                         \
+    {                                                        \
+      uint64_t r = bench_rand(&seed);                        \
+      name##_node *p = name##_find(t, make_key(r));          \
+      found += p != NULL ? p->value.payload : 0;             \
+    }                                                        \
+    report(impl, (n), insert_ns, bench_now_ns() - start, found); \
+    name##_delete(t);                                        \
+  } while (0)
+
+#define KEY_INT(r) ((int)(r))
+#define KEY_U64(r) (r)
+#define KEY_PAIR(r) ((struct pair_key){(uint32_t)((r) >> 32), (uint32_t)(r)})
+
+// 사용법: ./bench-tmpl [n]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+  printf("impl,n,insert_ns_per_op,find_ns_per_op,checksum\n");
+
+  // 기본 트리: int 키만 저장하고 값은 저장하지 않음
+  {
+    uint64_t seed = 42, found = 0;
+    rbtree *t = new_rbtree();
+    uint64_t start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      rbtree_insert(t, (key_t)bench_rand(&seed));
+    uint64_t insert_ns = bench_now_ns() - start;
+    seed = 42;
+    start = bench_now_ns();
+    for (size_t i = 0; i < n; i++)
+      found += rbtree_find(t, (key_t)bench_rand(&seed)) != NULL;
+    report("rbtree_int", n, insert_ns, bench_now_ns() - start, found);
+    delete_rbtree(t);
+  }
+
+  BENCH_TMPL(intmap, "tmpl_int", n, KEY_INT);
+  BENCH_TMPL(u64map, "tmpl_u64", n, KEY_U64);
+  BENCH_TMPL(pairmap, "tmpl_pair", n, KEY_PAIR);
+  return 0;
+}
@@ -0,0 +1,90 @@
+#include "bench.h"
+#include "rbtree.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// 비교용: 이전 버전의 재귀 중위 순회
+static void inorder_recursive(const rbtree *t, node_t *node, key_t *arr, const size_t n, size_t *index)
+{
+  if (node == t->nil || *index >= n)
+    return;
+
+  inorder_recursive(t, node->left, arr, n, index);
+  if (*index < n)
+    arr[(*index)++] = node->key;
+  inorder_recursive(t, node->right, arr, n, index);
+}
+
+// 비교용: 이전 버전의 재귀 후위 순회 삭제
+static void delete_recursive(rbtree *t, node_t *node)
+{
+  if (node == t->nil)
+    return;
+
+  delete_recursive(t, node->left);
+  delete_recursive(t, node->right);
+  rbtree_node_free(t, node);
+}
+
+static rbtree *build_random(size_t n, uint64_t seed)
+{
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+    rbtree_insert(t, (key_t)bench_rand(&seed));
+  return t;
+}
+
+// 재귀 / 반복 중위 순회와 삭제 비교
+// 사용법: ./bench-traverse [n] [prefix]
+int main(int argc, char *argv[])
+{
+  size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+  size_t prefix = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+  key_t *arr = malloc(n * sizeof(key_t));
+  if (arr == NULL)
+    return 1;
+
+  rbtree *t = build_random(n, 42);
+  uint64_t start;
+  size_t index;
+
+  printf("op,impl,n,ms\n");
+
+  // 1. 전체 export
+  start = bench_now_ns();
+  index = 0;
+  inorder_recursive(t, t->root, arr, n, &index);
+  printf("to_array,recursive,%zu,%.3f\n", n, (bench_now_ns() - start) / 1e6);
+
+  start = bench_now_ns();
+  rbtree_to_array(t, arr, n);
+  printf("to_array,iterative,%zu,%.3f\n", n, (bench_now_ns() - start) / 1e6);
+
+  // 2. 앞쪽 prefix개만 export (버퍼가 차면 멈추는지 확인)
+  start = bench_now_ns();
+  index = 0;
+  inorder_recursive(t, t->root, arr, prefix, &index);
+  printf("to_array_prefix,recursive,%zu,%.3f\n", prefix, (bench_now_ns() - start) / 1e6);
+
+  start = bench_now_ns();
+  rbtree_to_array(t, arr, prefix);
+  printf("to_array_prefix,iterative,%zu,%.3f\n", prefix, (bench_now_ns() - start) / 1e6);
+
+  // 3. 노드 단위 teardown (두 구현 모두 같은 순서로 다시 만든 트리에서 번갈아 재서, 노드 배치 차이가 한쪽에만 실리지 않게 함)
+  delete_rbtree(t);
+  for (int round = 0; round < 4; round++)
+  {
+    t = build_random(n, 42);
+    start = bench_now_ns();
+    if (round % 2 == 0)
+      delete_recursive(t, t->root);
+    else
+      delete_node(t, t->root);
+    t->root = t->nil;
+    printf("teardown,%s,%zu,%.3f\n", round % 2 == 0 ? "recursive" : "iterative", n, (bench_now_ns() - start) / 1e6);
+    delete_rbtree(t);
+  }
+
+  free(arr);
+  return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/resource.h>
+#include <time.h>
+
+// 현재 시각을 나노초 단위로 반환 (CLOCK_MONOTONIC)
+static inline uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 고정 시드로 재현 가능한 xorshift64* 난수 생성기
+static inline uint64_t bench_rand(uint64_t *state)
+{
+  uint64_t x = *state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *state = x;
+  return x * 0x2545F4914F6CDD1Dull;
+}
+
+// 초당 연산 수 계산
+static inline double bench_ops_per_sec(uint64_t ops, uint64_t ns)
+{
+  return ns == 0 ? 0.0 : (double)ops * 1e9 / (double)ns;
+}
+
+// 프로세스의 최대 RSS (바이트)
+static inline size_t bench_peak_rss(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (size_t)ru.ru_maxrss * 1024;
+}
+
+#endif  // _BENCH_H_
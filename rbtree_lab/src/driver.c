@@ -1,5 +1,364 @@
 #include "rbtree.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
-int main(int argc, char *argv[]) {
+// 연산 trace를 rbtree에 그대로 재생하고 연산 종류별 처리량과 지연 시간 분위수를 출력하는 도구
+// 사용법: ./driver trace
+//
+// trace 형식 (파일을 mmap해서 복사 없이 바로 읽음)
+// - 텍스트: 한 줄에 연산 하나, '#'부터 줄 끝까지는 주석
+//     i <key>        rbtree_insert
+//     f <key>        rbtree_find
+//     e <key>        rbtree_erase_key
+//     r <lo> <hi>    rbtree_range로 [lo, hi) 읽기
+// - 바이너리: 8바이트 매직 "RBTRACE1", 4바이트 바이트 순서 표시(DRIVER_BYTE_ORDER) 뒤에 driver_record가 빈틈없이 이어짐
+//   모두 trace를 만든 기계의 바이트 순서, 순서가 다른 기계에서 만든 파일은 표시가 뒤집혀 보이므로 거부
+//
+// 출력: op,count,ops_per_sec,mean_ns,p50_ns,p99_ns,p999_ns,max_ns (CSV, 마지막 줄 all은 전체)
 
-}
\ No newline at end of file
+#define DRIVER_MAGIC "RBTRACE1"
+#define DRIVER_MAGIC_LEN 8
+#define DRIVER_BYTE_ORDER 0x01020304u
+#define DRIVER_RANGE_CAP 65536  // range 한 번에 읽는 최대 키 수
+
+#define DRIVER_HIST_SUB_BITS 5                                      // 2의 거듭제곱 구간마다 32칸 (상대 오차 약 3%)
+#define DRIVER_HIST_SUB (1u << DRIVER_HIST_SUB_BITS)
+#define DRIVER_HIST_BUCKETS ((64 - DRIVER_HIST_SUB_BITS + 1) * DRIVER_HIST_SUB)
+
+typedef enum { OP_INSERT, OP_FIND, OP_ERASE, OP_RANGE, OP_COUNT } driver_op;
+
+static const char *op_names[] = {"insert", "find", "erase", "range"};
+static const char op_chars[] = {'i', 'f', 'e', 'r'};
+
+// 바이너리 trace의 레코드 하나 (12바이트)
+typedef struct {
+  uint8_t op;     // driver_op
+  uint8_t pad[3];
+  int32_t key;    // range면 lo
+  int32_t hi;     // range의 hi, 다른 연산은 0
+} driver_record;
+
+// 지연 시간 히스토그램 (HDR 히스토그램처럼 지수 구간마다 같은 수의 칸으로 나눔)
+typedef struct {
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t buckets[DRIVER_HIST_BUCKETS];
+} driver_hist;
+
+static inline uint64_t driver_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/// @brief 지연 시간이 들어갈 히스토그램 칸을 구하는 함수
+/// @param ns 지연 시간
+/// @return 칸 번호 (DRIVER_HIST_SUB 미만은 값 그대로, 그 위는 최상위 비트 위치와 다음 5비트로 나눔)
+static size_t driver_hist_index(uint64_t ns)
+{
+  if (ns < DRIVER_HIST_SUB)
+    return (size_t)ns;
+
+  unsigned int msb = 63 - (unsigned int)__builtin_clzll(ns);
+  unsigned int shift = msb - DRIVER_HIST_SUB_BITS;
+  return (size_t)(shift + 1) * DRIVER_HIST_SUB + (size_t)((ns >> shift) - DRIVER_HIST_SUB);
+}
+
+/// @brief 히스토그램 칸에 들어가는 가장 큰 지연 시간을 구하는 함수
+/// @param index 칸 번호
+/// @return 그 칸의 상한 (분위수는 이 값으로 보고)
+static uint64_t driver_hist_value(size_t index)
+{
+  if (index < DRIVER_HIST_SUB)
+    return index;
+
+  unsigned int shift = (unsigned int)(index / DRIVER_HIST_SUB) - 1;
+  uint64_t base = (uint64_t)(DRIVER_HIST_SUB + index % DRIVER_HIST_SUB) << shift;
+  return base + ((uint64_t)1 << shift) - 1;
+}
+
+static void driver_hist_add(driver_hist *h, uint64_t ns)
+{
+  h->count++;
+  h->total_ns += ns;
+  if (ns > h->max_ns)
+    h->max_ns = ns;
+  h->buckets[driver_hist_index(ns)]++;
+}
+
+static void driver_hist_merge(driver_hist *dst, const driver_hist *src)
+{
+  dst->count += src->count;
+  dst->total_ns += src->total_ns;
+  if (src->max_ns > dst->max_ns)
+    dst->max_ns = src->max_ns;
+  for (size_t i = 0; i < DRIVER_HIST_BUCKETS; i++)
+    dst->buckets[i] += src->buckets[i];
+}
+
+/// @brief 히스토그램에서 분위수를 구하는 함수
+/// @param h 히스토그램
+/// @param q 분위 (0 < q <= 1)
+/// @return q 분위의 지연 시간 (ns, 칸의 상한이므로 max_ns를 넘지 않게 자름), 빈 히스토그램이면 0
+static uint64_t driver_hist_quantile(const driver_hist *h, double q)
+{
+  if (h->count == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)(q * h->count + 0.5);
+  if (rank == 0)
+    rank = 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < DRIVER_HIST_BUCKETS; i++)
+  {
+    seen += h->buckets[i];
+    if (seen >= rank)
+    {
+      uint64_t v = driver_hist_value(i);
+      return v < h->max_ns ? v : h->max_ns;
+    }
+  }
+  return h->max_ns;
+}
+
+static void driver_hist_print(const char *name, const driver_hist *h)
+{
+  printf("%s,%llu,%.0f,%.1f,%llu,%llu,%llu,%llu\n", name, (unsigned long long)h->count,
+         h->total_ns == 0 ? 0.0 : (double)h->count * 1e9 / (double)h->total_ns,
+         h->count == 0 ? 0.0 : (double)h->total_ns / (double)h->count,
+         (unsigned long long)driver_hist_quantile(h, 0.5), (unsigned long long)driver_hist_quantile(h, 0.99),
+         (unsigned long long)driver_hist_quantile(h, 0.999), (unsigned long long)h->max_ns);
+}
+
+// trace 재생 상태
+typedef struct {
+  rbtree *t;
+  key_t *range_buf;
+  size_t sink;                  // 결과를 모아서 연산이 최적화로 지워지지 않게 함
+  driver_hist hist[OP_COUNT];
+} driver_ctx;
+
+/// @brief 연산 하나를 실행하고 걸린 시간을 그 연산의 히스토그램에 더하는 함수
+/// @param ctx 재생 상태
+/// @param op 연산 종류
+/// @param key 키 (range면 lo)
+/// @param hi range의 hi
+/// @return 성공 시 0, insert 메모리 할당 실패 시 -1
+static int driver_run_op(driver_ctx *ctx, driver_op op, key_t key, key_t hi)
+{
+  uint64_t start = driver_now_ns();
+  switch (op)
+  {
+  case OP_INSERT:
+    if (rbtree_insert(ctx->t, key) == NULL)
+      return -1;
+    break;
+  case OP_FIND:
+    ctx->sink += rbtree_find(ctx->t, key) != NULL;
+    break;
+  case OP_ERASE:
+    ctx->sink += rbtree_erase_key(ctx->t, key) == 0;
+    break;
+  default:
+    ctx->sink += rbtree_range(ctx->t, key, hi, ctx->range_buf, DRIVER_RANGE_CAP);
+    break;
+  }
+  driver_hist_add(&ctx->hist[op], driver_now_ns() - start);
+  return 0;
+}
+
+/// @brief 바이너리 trace를 재생하는 함수
+/// @param ctx 재생 상태
+/// @param data 매직 뒤의 바이트 순서 표시
+/// @param size 매직 뒤의 크기
+/// @return 성공 시 0, 형식 오류나 메모리 할당 실패 시 -1
+static int driver_replay_binary(driver_ctx *ctx, const char *data, size_t size)
+{
+  uint32_t order = 0;
+  if (size >= sizeof(order))
+    memcpy(&order, data, sizeof(order));
+  if (order != DRIVER_BYTE_ORDER)
+  {
+    fprintf(stderr, "driver: binary trace has a missing or foreign byte order mark\n");
+    return -1;
+  }
+  data += sizeof(order);
+  size -= sizeof(order);
+
+  if (size % sizeof(driver_record) != 0)
+  {
+    fprintf(stderr, "driver: binary trace size is not a multiple of %zu\n", sizeof(driver_record));
+    return -1;
+  }
+
+  for (size_t off = 0; off < size; off += sizeof(driver_record))
+  {
+    driver_record rec;
+    memcpy(&rec, data + off, sizeof(rec)); // mmap 영역은 레코드 정렬을 보장하지 않음
+    if (rec.op >= OP_COUNT)
+    {
+      fprintf(stderr, "driver: bad op %u in record %zu\n", rec.op, off / sizeof(driver_record));
+      return -1;
+    }
+    if (driver_run_op(ctx, (driver_op)rec.op, (key_t)rec.key, (key_t)rec.hi) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+/// @brief 공백을 건너뛰고 10진 정수 하나를 읽는 함수 (NUL로 끝나지 않는 mmap 영역을 그대로 읽음)
+/// @param p 읽을 위치 (읽은 뒤 위치로 옮김)
+/// @param end 줄 끝
+/// @param out 읽은 값
+/// @return 성공 시 0, 숫자가 없거나 key_t 범위를 넘거나 숫자 바로 뒤에 공백 / 주석이 아닌 글자가 있으면 -1
+static int driver_parse_int(const char **p, const char *end, key_t *out)
+{
+  const char *s = *p;
+  while (s < end && (*s == ' ' || *s == '\t'))
+    s++;
+
+  int neg = 0;
+  if (s < end && (*s == '-' || *s == '+'))
+    neg = *s++ == '-';
+  if (s == end || *s < '0' || *s > '9')
+    return -1;
+
+  const long long limit = neg ? -(long long)INT_MIN : INT_MAX;
+  long long v = 0;
+  while (s < end && *s >= '0' && *s <= '9')
+  {
+    v = v * 10 + (*s++ - '0');
+    if (v > limit) // 자릿수가 더 있어도 넘치기 전에 멈춤
+      return -1;
+  }
+  if (s < end && *s != ' ' && *s != '\t' && *s != '\r' && *s != '#') // "12abc" 같은 숫자
+    return -1;
+  *out = (key_t)(neg ? -v : v);
+  *p = s;
+  return 0;
+}
+
+/// @brief 텍스트 trace를 재생하는 함수
+/// @param ctx 재생 상태
+/// @param data 파일 내용
+/// @param size 파일 크기
+/// @return 성공 시 0, 형식 오류나 메모리 할당 실패 시 -1
+static int driver_replay_text(driver_ctx *ctx, const char *data, size_t size)
+{
+  const char *end = data + size;
+  size_t line = 0;
+
+  for (const char *p = data; p < end;)
+  {
+    const char *eol = memchr(p, '\n', (size_t)(end - p));
+    if (eol == NULL)
+      eol = end;
+    line++;
+
+    const char *s = p;
+    p = eol + 1;
+    while (s < eol && (*s == ' ' || *s == '\t' || *s == '\r'))
+      s++;
+    if (s == eol || *s == '#') // 빈 줄, 주석
+      continue;
+
+    driver_op op = OP_COUNT;
+    for (int i = 0; i < OP_COUNT; i++)
+      if (*s == op_chars[i])
+        op = (driver_op)i;
+    s++;
+
+    key_t key = 0, hi = 0;
+    int bad = op == OP_COUNT || driver_parse_int(&s, eol, &key) != 0 || (op == OP_RANGE && driver_parse_int(&s, eol, &hi) != 0);
+    while (!bad && s < eol && (*s == ' ' || *s == '\t' || *s == '\r'))
+      s++;
+    if (bad || (s < eol && *s != '#')) // 인자 뒤에는 주석만 올 수 있음
+    {
+      fprintf(stderr, "driver: parse error at line %zu\n", line);
+      return -1;
+    }
+    if (driver_run_op(ctx, op, key, hi) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc != 2)
+  {
+    fprintf(stderr, "usage: %s trace\n", argv[0]);
+    return 2;
+  }
+
+  int fd = open(argv[1], O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    perror(argv[1]);
+    return 1;
+  }
+
+  size_t size = (size_t)st.st_size;
+  const char *data = NULL;
+  if (size > 0)
+  {
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+      perror("mmap");
+      return 1;
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL); // 앞에서부터 한 번만 읽음
+  }
+  close(fd);
+
+  driver_ctx *ctx = calloc(1, sizeof(driver_ctx));
+  if (ctx == NULL)
+    return 1;
+  ctx->t = new_rbtree();
+  ctx->range_buf = malloc(DRIVER_RANGE_CAP * sizeof(key_t));
+  if (ctx->t == NULL || ctx->range_buf == NULL)
+    return 1;
+
+  uint64_t start = driver_now_ns();
+  int ret;
+  if (size >= DRIVER_MAGIC_LEN && memcmp(data, DRIVER_MAGIC, DRIVER_MAGIC_LEN) == 0)
+    ret = driver_replay_binary(ctx, data + DRIVER_MAGIC_LEN, size - DRIVER_MAGIC_LEN);
+  else
+    ret = driver_replay_text(ctx, data, size);
+  uint64_t wall_ns = driver_now_ns() - start;
+
+  if (ret == 0)
+  {
+    driver_hist all = {0};
+    printf("op,count,ops_per_sec,mean_ns,p50_ns,p99_ns,p999_ns,max_ns\n");
+    for (int i = 0; i < OP_COUNT; i++)
+    {
+      driver_hist_print(op_names[i], &ctx->hist[i]);
+      driver_hist_merge(&all, &ctx->hist[i]);
+    }
+    driver_hist_print("all", &all);
+    // 시각을 재는 비용까지 포함한 실제 재생 처리량
+    fprintf(stderr, "replayed %llu ops in %.3f s (%.0f ops/sec wall), final size %zu, sink %zu\n",
+            (unsigned long long)all.count, (double)wall_ns / 1e9,
+            wall_ns == 0 ? 0.0 : (double)all.count * 1e9 / (double)wall_ns, rbtree_size(ctx->t), ctx->sink);
+  }
+
+  delete_rbtree(ctx->t);
+  free(ctx->range_buf);
+  free(ctx);
+  if (size > 0)
+    munmap((void *)data, size);
+  return ret == 0 ? 0 : 1;
+}
@@ -1,56 +1,271 @@
 #include "rbtree.h"
+#include "rbtree_workers.h"
+#include <assert.h>
 #include <stdlib.h>
+#ifdef RBTREE_STATS
+#include <stdatomic.h>
+#endif
 
-/// @brief 레드블랙트리 생성 및 초기화
+#define RBTREE_SLAB_MIN 64      // 첫 슬랩의 노드 수
+#define RBTREE_SLAB_MAX 65536   // 슬랩 하나의 최대 노드 수
+
+// 노드를 한 번에 여러 개 할당해 두는 슬랩
+struct rbtree_slab {
+  struct rbtree_slab *next; // 다음 슬랩 (먼저 만든 슬랩)
+  size_t cap;               // 슬랩이 가진 노드 수
+  size_t used;              // 지금까지 잘라서 나눠준 노드 수
+  node_t nodes[];           // 노드 배열
+};
+
+#ifdef RBTREE_STATS
+// 풀 단위로 쌓는 계측 카운터 (병렬 연산에서는 여러 스레드가 같은 풀을 쓰므로 atomic)
+typedef struct {
+  atomic_uint_fast64_t left_rotations, right_rotations;
+  atomic_uint_fast64_t insert_fixup_loops, delete_fixup_loops;
+  atomic_uint_fast64_t finds, find_compares;
+  atomic_uint_fast64_t inserts, insert_compares;
+  atomic_uint_fast64_t allocs, frees;
+} rbtree_counters;
+
+// 계측 카운터에 v를 더함 (순서 보장이 필요 없으므로 relaxed)
+#define rbtree_stat_add(t, field, v) atomic_fetch_add_explicit(&(t)->pool->stats.field, (v), memory_order_relaxed)
+#define rbtree_stat_load(t, field) atomic_load_explicit(&(t)->pool->stats.field, memory_order_relaxed)
+#else
+// RBTREE_STATS가 아니면 아무것도 하지 않음 (v를 세던 지역 변수도 컴파일러가 지움)
+#define rbtree_stat_add(t, field, v) ((void)(v))
+#endif
+
+// 노드 풀과 nil을 담는 저장소, split / join으로 노드를 주고받는 트리끼리 공유
+struct rbtree_pool {
+  size_t refs;          // 이 풀을 쓰는 트리 수
+  node_t nil;           // 풀을 공유하는 트리들이 함께 쓰는 sentinel
+  rbtree_slab *slabs;   // 슬랩 목록 (RBTREE_NO_POOL이면 사용하지 않음)
+  node_t *free_list;    // erase된 노드를 재사용하기 위한 free list
+#ifdef RBTREE_STATS
+  rbtree_counters stats;  // 이 풀을 쓰는 트리들의 계측 카운터
+#endif
+};
+
+/// @brief 주어진 풀을 쓰는 빈 트리를 만드는 함수
+/// @param pool 트리가 사용할 풀 (참조 수 증가)
 /// @return 초기화된 레드 블랙 트리의 포인터, 메모리 할당 실패 시 NULL
-rbtree *new_rbtree(void)
+static rbtree *rbtree_new_in(rbtree_pool *pool)
 {
   // 트리 구조체 동적 할당
   rbtree *t = (rbtree *)calloc(1, sizeof(rbtree));
   if (t == NULL) // 메모리 할당 실패 시 NULL 리턴
     return NULL;
 
-  // nil 노드 동적 할당
-  node_t *nil = (node_t *)calloc(1, sizeof(node_t));
-  if (nil == NULL) // nil 메모리 할당 실패 시
-  {
-    free(t); // 트리 구조체 메모리 해제
-    return NULL; // 메모리 할당 실패 시 NULL 반환
-  }
+  pool->refs++;
+  t->pool = pool;
+  t->nil = &pool->nil;
+  t->root = t->nil;
+  t->leftmost = t->nil;
+  t->rightmost = t->nil;
+  t->count = 0;
+
+  return t;
+}
+
+/// @brief 레드블랙트리 생성 및 초기화
+/// @return 초기화된 레드 블랙 트리의 포인터, 메모리 할당 실패 시 NULL
+rbtree *new_rbtree(void)
+{
+  // 풀과 nil 노드 동적 할당
+  rbtree_pool *pool = (rbtree_pool *)calloc(1, sizeof(rbtree_pool));
+  if (pool == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
 
   // nil은 항상 블랙
-  nil->color = RBTREE_BLACK;
+  node_t *nil = &pool->nil;
+  rbtree_set_color(nil, RBTREE_BLACK);
   // 초기화
   nil->left = nil;
   nil->right = nil;
-  nil->parent = nil;
+  rbtree_set_parent(nil, nil);
 
-  t->nil = nil;
-  t->root = nil;
+  rbtree *t = rbtree_new_in(pool);
+  if (t == NULL) // 트리 메모리 할당 실패 시
+  {
+    free(pool); // 풀 메모리 해제
+    return NULL;
+  }
 
   return t;
 }
 
+/// @brief t와 노드 풀, nil을 공유하는 빈 트리를 만드는 함수
+/// @param t 풀을 공유할 트리 포인터
+/// @return 초기화된 레드 블랙 트리의 포인터, 메모리 할당 실패 시 NULL
+/// @note 같은 풀을 쓰는 트리끼리는 rbtree_join, rbtree_union 등에서 노드를 옮기지 않고 O(log n)에 합칠 수 있음
+///       같은 풀을 쓰는 트리들은 동시에 수정하면 안 됨
+rbtree *new_rbtree_shared(rbtree *t)
+{
+  return rbtree_new_in(t->pool);
+}
+
+#ifdef RBTREE_MULTISET
+/// @brief 이미 있는 노드의 키 개수를 바꾸는 함수 (트리 구조는 그대로)
+/// @param t 대상 트리 포인터
+/// @param node 개수를 바꿀 노드
+/// @param delta 더할 개수 (줄이려면 음수, 결과는 1 이상이어야 함)
+static void rbtree_add_count(rbtree *t, node_t *node, int delta)
+{
+  node->count += delta;
+  if (t->count != RBTREE_COUNT_UNKNOWN)
+    t->count += delta;
+#ifdef RBTREE_ORDER_STAT
+  for (node_t *cur = node; cur != t->nil; cur = rbtree_parent(cur))
+    cur->size += delta; // 루트까지 경로 위의 서브트리 크기도 같이 바뀜
+#endif
+}
+#endif
+
 /// @brief 레드블렉트리 삽입 함수
 /// @param t 삽입할 트리 포인터
 /// @param key 삽입할 키 값
-/// @return 삽입 성공 시 삽입한 노드 리턴, 중복 값이라면 삽입한 노드 리턴
+/// @return 삽입 성공 시 삽입한 노드 리턴, 중복 값이라면 삽입한 노드 리턴, 메모리 할당 실패 시 NULL
+/// @note RBTREE_MULTISET이면 같은 키가 이미 있을 때 새 노드를 만들지 않고 그 노드의 개수를 늘려서 반환
 node_t *rbtree_insert(rbtree *t, const key_t key) 
 {
-  // 삽입할 노드 초기화
-  node_t *cur = (node_t*)calloc(1, sizeof(node_t));
-  cur->color = RBTREE_RED;
+#ifdef RBTREE_MULTISET
+  node_t *parent = t->nil;
+  node_t **link = &t->root;
+  uint64_t compares = 0; // 키를 비교한 노드 수
+  rbtree_stat_add(t, inserts, 1);
+  for (node_t *cur = t->root; cur != t->nil; cur = *link)
+  {
+    compares++;
+    if (key == cur->key) // 같은 키가 있으면 개수만 증가
+    {
+      rbtree_stat_add(t, insert_compares, compares);
+      rbtree_add_count(t, cur, 1);
+      return cur;
+    }
+    parent = cur;
+    link = key < cur->key ? &cur->left : &cur->right;
+  }
+  rbtree_stat_add(t, insert_compares, compares);
+
+  node_t *node = rbtree_node_alloc(t);
+  if (node == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
+  node->key = key;
+  rbtree_link_node(t, node, parent, link);
+  rbtree_insert_fixup(t, node);
+  return node;
+#else
+  // 삽입할 노드 할당
+  node_t *cur = rbtree_node_alloc(t);
+  if (cur == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
+  cur->key = key;
+  return rbtree_insert_node(t, cur);
+#endif
+}
+
+/// @brief hint 노드 바로 옆에 삽입하는 함수 (거의 정렬된 입력에서 루트부터 내려가지 않음)
+/// @param t 삽입할 트리 포인터
+/// @param hint 삽입 위치 근처의 노드 (직전에 삽입한 노드, rbtree_max 등), NULL이면 일반 삽입
+/// @param key 삽입할 키 값
+/// @return 삽입한 노드 (RBTREE_MULTISET에서 같은 키가 있었으면 그 노드), 메모리 할당 실패 시 NULL
+node_t *rbtree_insert_hint(rbtree *t, node_t *hint, const key_t key)
+{
+  if (hint == NULL) // hint가 없으면 일반 삽입
+    return rbtree_insert(t, key);
+
+#ifdef RBTREE_MULTISET
+  if (hint->key == key)
+  {
+    rbtree_add_count(t, hint, 1);
+    return hint;
+  }
+#endif
+
+  node_t *parent; // 새 노드의 부모
+  node_t **link;  // 새 노드를 연결할 포인터 위치
+
+  // case 1: key가 hint 이상이면 hint와 그 후속자 사이에 들어가야 함
+  if (hint->key <= key)
+  {
+    // hint가 최대 노드면 후속자가 없으므로 부모를 따라 올라갈 필요 없음
+    node_t *next = hint == t->rightmost ? NULL : rbtree_next(t, hint);
+    if (next != NULL && next->key < key) // 인접 위치가 아니면 일반 삽입
+      return rbtree_insert(t, key);
+#ifdef RBTREE_MULTISET
+    if (next != NULL && next->key == key)
+    {
+      rbtree_add_count(t, next, 1);
+      return next;
+    }
+#endif
+
+    if (hint->right == t->nil) // hint의 오른쪽이 비어 있으면 그 자리에
+    {
+      parent = hint;
+      link = &hint->right;
+    }
+    else // 아니면 후속자(오른쪽 서브트리의 최소 노드)의 왼쪽 자리에
+    {
+      parent = next;
+      link = &next->left;
+    }
+  }
+  // case 2: key가 hint보다 작으면 선행자와 hint 사이에 들어가야 함 (case 1의 대칭)
+  else
+  {
+    node_t *prev = hint == t->leftmost ? NULL : rbtree_prev(t, hint);
+    if (prev != NULL && prev->key > key)
+      return rbtree_insert(t, key);
+#ifdef RBTREE_MULTISET
+    if (prev != NULL && prev->key == key)
+    {
+      rbtree_add_count(t, prev, 1);
+      return prev;
+    }
+#endif
+
+    if (hint->left == t->nil)
+    {
+      parent = hint;
+      link = &hint->left;
+    }
+    else
+    {
+      parent = prev;
+      link = &prev->right;
+    }
+  }
+
+  node_t *cur = rbtree_node_alloc(t);
+  if (cur == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
   cur->key = key;
-  cur->left = t->nil;
-  cur->right = t->nil;
-  cur->parent = t->nil;
+  rbtree_link_node(t, cur, parent, link);
+  rbtree_insert_fixup(t, cur);
+  return cur;
+}
 
+/// @brief 호출자가 준비한 노드를 트리에 연결하는 함수 (intrusive, 트리 안에서 할당하지 않음)
+/// @param t 삽입할 트리 포인터
+/// @param node key가 채워진 노드 (사용자 구조체 안에 node_t를 멤버로 둘 수 있음)
+/// @return 삽입한 노드
+/// @note 트리는 이 노드를 해제하지 않으므로 delete_rbtree 전에 rbtree_remove_node로 모두 떼어내야 함
+///       RBTREE_MULTISET이어도 같은 키의 노드와 합치지 않고 개수 1인 노드로 따로 연결함
+node_t *rbtree_insert_node(rbtree *t, node_t *node)
+{
   node_t *parent = t->nil;    // 삽입 위치의 부모 노드 저장 변수
   node_t *new_node = t->root; // 현재 탐색 중인 노드 
+  node_t **link = &t->root;   // 새 노드를 연결할 포인터 위치
+  uint64_t compares = 0;      // 키를 비교한 노드 수
 
   while (new_node != t->nil) // nil 노드가 아닐때까지 반복
   {
     parent = new_node; // 현재 노드를 부모로 저장
+    compares++;
 
     // if (key == new_node->key) // 키가 같다면
     // {
@@ -58,205 +273,2048 @@ node_t *rbtree_insert(rbtree *t, const key_t key)
     //   return new_node; // 기존 노드 반환
     // }
 
-    if (key < new_node->key) // 키가 작으면
-      new_node = new_node->left; // 왼쪽으로 이동
+    if (node->key < new_node->key) // 키가 작으면
+      link = &new_node->left; // 왼쪽으로 이동
     else // 키가 크면
-      new_node = new_node->right; // 오른쪽으로 이동
+      link = &new_node->right; // 오른쪽으로 이동
+    new_node = *link;
   }
-  
-  cur->parent = parent; // 부모 노드 설정
-  
-  if (parent == t->nil) // 루트 노드가 없다면, 새 노드를 루트로
-    t->root = cur;
-  else if (key < parent->key) // 키가 부모보다 작으면
-    parent->left = cur; // 부모의 왼쪽 노드 연결
-  else // 키가 부모보다 크면
-    parent->right = cur; // 부모의 오른쪽 노드 연결
+  rbtree_stat_add(t, inserts, 1);
+  rbtree_stat_add(t, insert_compares, compares);
 
-  rbtree_insert_fixup(t, cur);
-  return cur;
+  rbtree_link_node(t, node, parent, link);
+  rbtree_insert_fixup(t, node);
+  return node;
 }
 
-/// @brief 레드블랙트리 삽입 후 색상 및 밸런싱 함수
+/// @brief 호출자가 직접 찾은 위치에 노드를 빨간색으로 연결하는 함수 (밸런싱은 rbtree_insert_fixup으로)
+/// @param t 삽입할 트리 포인터
+/// @param node 연결할 노드
+/// @param parent 새 노드의 부모 (트리가 비었으면 nil)
+/// @param link 새 노드를 가리키게 될 포인터 (&t->root, &parent->left, &parent->right 중 하나)
+void rbtree_link_node(rbtree *t, node_t *node, node_t *parent, node_t **link)
+{
+  rbtree_set_color(node, RBTREE_RED); // 새 노드는 항상 RED
+  rbtree_set_parent(node, parent);    // 부모 노드 설정
+  node->left = t->nil;
+  node->right = t->nil;
+  *link = node;             // 부모의 자식 (또는 루트) 으로 연결
+  if (t->count != RBTREE_COUNT_UNKNOWN)
+    t->count++;
+
+  // 최소 / 최대 노드 캐시 갱신: 빈 트리였거나 끝 노드의 바깥쪽에 붙은 경우
+  if (parent == t->nil)
+  {
+    t->leftmost = node;
+    t->rightmost = node;
+  }
+  else if (parent == t->leftmost && link == &parent->left)
+    t->leftmost = node;
+  else if (parent == t->rightmost && link == &parent->right)
+    t->rightmost = node;
+
+#ifdef RBTREE_MULTISET
+  node->count = 1;
+#endif
+#ifdef RBTREE_ORDER_STAT
+  node->size = 1;
+  for (node_t *cur = parent; cur != t->nil; cur = rbtree_parent(cur))
+    cur->size++; // 경로 위의 모든 서브트리에 노드가 하나 추가됨
+#endif
+}
+
+/// @brief 빨간 노드 cur 위의 red-red 위반을 고치는 함수 (루트 색은 건드리지 않음)
 /// @param t 조정할 트리 포인터
-/// @param cur 삽입된 노드
-void rbtree_insert_fixup(rbtree *t, node_t *cur)
+/// @param cur 빨간색으로 연결된 노드
+static void rbtree_insert_rebalance(rbtree *t, node_t *cur)
 {
   node_t *uncle = t->nil;
+  uint64_t loops = 0;
 
   // 부모가 RED인 경우
-  while (cur->parent->color == RBTREE_RED)
+  while (rbtree_color(rbtree_parent(cur)) == RBTREE_RED)
   {
+    loops++;
     // case 1: 부모가 조부모의 왼쪽 자식일 경우
-    if (cur->parent == cur->parent->parent->left)
+    if (rbtree_parent(cur) == rbtree_parent(rbtree_parent(cur))->left)
     {
-      uncle = cur->parent->parent->right; // 삼촌 노드는 조부모의 오른쪽 자식
+      uncle = rbtree_parent(rbtree_parent(cur))->right; // 삼촌 노드는 조부모의 오른쪽 자식
       
       // case 1-1: 삼촌이 RED이면 색상 변경
-      if (uncle->color == RBTREE_RED)
+      if (rbtree_color(uncle) == RBTREE_RED)
       {
-        cur->parent->color = RBTREE_BLACK;
-        uncle->color = RBTREE_BLACK;
-        cur->parent->parent->color = RBTREE_RED;
-        cur = cur->parent->parent; // 조부모에서 다시 검사
+        rbtree_set_color(rbtree_parent(cur), RBTREE_BLACK);
+        rbtree_set_color(uncle, RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(rbtree_parent(cur)), RBTREE_RED);
+        cur = rbtree_parent(rbtree_parent(cur)); // 조부모에서 다시 검사
       }
       // 삼촌이 BLACK인 경우
       else
       {
         // case 1-2: 삽입 노드가 오른쪽 자식이면 -> 왼쪽 회전으로 case 1-3으로 변환
-        if (cur == cur->parent->right)
+        if (cur == rbtree_parent(cur)->right)
         {
-          cur = cur->parent;
+          cur = rbtree_parent(cur);
           left_rotate(t, cur);
         }
 
-        // case 1-3: 삽입 노드가 왼쪽 자식이면 -> 재색칠 후 오른쪽 회전
-        cur->parent->color = RBTREE_BLACK;
-        cur->parent->parent->color = RBTREE_RED;
-        right_rotate(t, cur->parent->parent);
-      }
+        // case 1-3: 삽입 노드가 왼쪽 자식이면 -> 재색칠 후 오른쪽 회전
+        rbtree_set_color(rbtree_parent(cur), RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(rbtree_parent(cur)), RBTREE_RED);
+        right_rotate(t, rbtree_parent(rbtree_parent(cur)));
+      }
+    }
+    // case 2: 부모가 조부모의 오른쪽 자식일 경우 (case 1을 대칭 처리)
+    else
+    {
+      uncle = rbtree_parent(rbtree_parent(cur))->left; // 삼촌 노드는 조부모의 왼쪽 자식
+
+      // case 2-1: 삼촌이 RED -> 재색칠
+      if (rbtree_color(uncle) == RBTREE_RED)
+      {
+        rbtree_set_color(rbtree_parent(cur), RBTREE_BLACK);
+        rbtree_set_color(uncle, RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(rbtree_parent(cur)), RBTREE_RED);
+        cur = rbtree_parent(rbtree_parent(cur)); // 조부모에서 다시 검사
+      }
+      // 삼촌이 BLACK인 경우
+      else
+      {
+        // case 2-2: 삽입 노드가 왼쪽 자식 -> 오른쪽 회전으로 case 2-3으로 변환
+        if (cur == rbtree_parent(cur)->left)
+        {
+          cur = rbtree_parent(cur);
+          right_rotate(t, cur);
+        }
+        
+        // case 2-3: 삽입 노드가 오른쪽 자식이면 -> 재색칠 후 왼쪽 회전
+        rbtree_set_color(rbtree_parent(cur), RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(rbtree_parent(cur)), RBTREE_RED);
+        left_rotate(t, rbtree_parent(rbtree_parent(cur)));
+      }
+    }
+  }
+  rbtree_stat_add(t, insert_fixup_loops, loops);
+}
+
+/// @brief 레드블랙트리 삽입 후 색상 및 밸런싱 함수
+/// @param t 조정할 트리 포인터
+/// @param cur 삽입된 노드
+void rbtree_insert_fixup(rbtree *t, node_t *cur)
+{
+  rbtree_insert_rebalance(t, cur);
+
+  // 루트는 항상 BLACK이어야 하므로
+  rbtree_set_color(t->root, RBTREE_BLACK);
+}
+
+/// @brief 왼쪽 회전
+/// @param t 회전할 트리 포인터
+/// @param x 회전할 노드 값
+void left_rotate(rbtree *t, node_t *x)
+{
+  rbtree_stat_add(t, left_rotations, 1);
+  node_t *y = x->right; // y = x의 오른쪽 자식
+  x->right = y->left;   // x의 오른쪽 자식을 y의 왼쪽 자식으로 연결
+
+  if (y->left != t->nil) // y의 왼쪽 자식이 nil 노드가 아니라면
+    rbtree_set_parent(y->left, x); // 부모를 x로 연결
+  
+  rbtree_set_parent(y, rbtree_parent(x)); // y의 부모를 x의 부모로 연결
+
+  if (rbtree_parent(x) == t->nil) // x가 루트 노드였다면
+    t->root = y;           // y가 루트
+  else if (x == rbtree_parent(x)->left) // x가 부모의 왼쪽 자식이었다면
+    rbtree_parent(x)->left = y;         // y를 왼쪽 자식으로 연결
+  else                    // x가 부모의 오른쪽 자식이었다면
+    rbtree_parent(x)->right = y; // y를 오른쪽 자식으로 연결
+
+  y->left = x; // x를 y의 오른쪽 자식으로 연결
+  rbtree_set_parent(x, y); // x의 부모를 y로 설정
+
+#ifdef RBTREE_ORDER_STAT
+  y->size = x->size; // y가 x의 자리를 그대로 차지
+  x->size = x->left->size + x->right->size + rbtree_weight(x);
+#endif
+}
+
+/// @brief 오른쪽 회전
+/// @param t 회전할 트리 포인터
+/// @param x 회전할 노드 값
+void right_rotate(rbtree *t, node_t *x)
+{
+  rbtree_stat_add(t, right_rotations, 1);
+  node_t *y = x->left;
+  x->left = y->right;
+
+  if (y->right != t->nil)
+    rbtree_set_parent(y->right, x);
+    
+  rbtree_set_parent(y, rbtree_parent(x));
+
+  if (rbtree_parent(x) == t->nil)
+    t->root = y;
+  else if (x == rbtree_parent(x)->right)
+    rbtree_parent(x)->right = y;
+  else
+    rbtree_parent(x)->left = y;
+  
+  y->right = x;
+  rbtree_set_parent(x, y);
+
+#ifdef RBTREE_ORDER_STAT
+  y->size = x->size;
+  x->size = x->left->size + x->right->size + rbtree_weight(x);
+#endif
+}
+
+/// @brief 트리에서 사용할 노드 하나를 할당하는 함수
+/// @param t 노드를 할당할 트리 포인터
+/// @return 0으로 초기화된 노드 포인터, 메모리 할당 실패 시 NULL
+node_t *rbtree_node_alloc(rbtree *t)
+{
+  rbtree_stat_add(t, allocs, 1); // 실패해도 시도한 수로 셈
+#ifdef RBTREE_NO_POOL
+  (void)t;
+  return (node_t *)calloc(1, sizeof(node_t));
+#else
+  rbtree_pool *pool = t->pool;
+  node_t *node = pool->free_list;
+
+  // free list에 재사용할 노드가 있으면 꺼내서 사용
+  if (node != NULL)
+  {
+    pool->free_list = node->right; // free list는 right 포인터로 연결
+    *node = (node_t){0};
+    return node;
+  }
+
+  rbtree_slab *slab = pool->slabs;
+
+  // 현재 슬랩을 다 썼으면 새 슬랩 할당 (크기는 두 배씩, 최대 RBTREE_SLAB_MAX)
+  if (slab == NULL || slab->used == slab->cap)
+  {
+    size_t cap = slab == NULL ? RBTREE_SLAB_MIN : slab->cap * 2;
+    if (cap > RBTREE_SLAB_MAX)
+      cap = RBTREE_SLAB_MAX;
+
+    rbtree_slab *new_slab = (rbtree_slab *)malloc(sizeof(rbtree_slab) + cap * sizeof(node_t));
+    if (new_slab == NULL) // 메모리 할당 실패 시 NULL 반환
+      return NULL;
+
+    new_slab->next = slab;
+    new_slab->cap = cap;
+    new_slab->used = 0;
+    pool->slabs = slab = new_slab;
+  }
+
+  node = &slab->nodes[slab->used++];
+  *node = (node_t){0};
+  return node;
+#endif
+}
+
+#ifndef RBTREE_NO_POOL
+/// @brief n개의 노드를 하나의 슬랩에 연속으로 할당하는 함수
+/// @param t 노드를 할당할 트리 포인터
+/// @param n 할당할 노드 수
+/// @return 연속된 노드 배열의 시작 포인터, 메모리 할당 실패 시 NULL
+static node_t *rbtree_node_alloc_bulk(rbtree *t, size_t n)
+{
+  rbtree_slab *slab = (rbtree_slab *)malloc(sizeof(rbtree_slab) + n * sizeof(node_t));
+  if (slab == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
+  slab->cap = n;
+  slab->used = n; // 전부 사용 중으로 표시
+  rbtree_stat_add(t, allocs, n);
+
+  // 다 쓴 슬랩이므로 현재 잘라 쓰는 슬랩(맨 앞) 뒤에 연결
+  rbtree_pool *pool = t->pool;
+  if (pool->slabs == NULL)
+  {
+    slab->next = NULL;
+    pool->slabs = slab;
+  }
+  else
+  {
+    slab->next = pool->slabs->next;
+    pool->slabs->next = slab;
+  }
+
+  return slab->nodes;
+}
+#endif
+
+/// @brief 노드를 트리의 free list로 반환하는 함수
+/// @param t 노드가 속한 트리 포인터
+/// @param node 반환할 노드 포인터
+void rbtree_node_free(rbtree *t, node_t *node)
+{
+  rbtree_stat_add(t, frees, 1);
+#ifdef RBTREE_NO_POOL
+  (void)t;
+  free(node);
+#else
+  node->right = t->pool->free_list; // free list 맨 앞에 연결
+  t->pool->free_list = node;
+#endif
+}
+
+/// @brief 풀의 참조 수를 줄이고, 더 쓰는 트리가 없으면 슬랩과 풀을 해제하는 함수
+/// @param pool 해제할 풀 포인터
+static void rbtree_pool_release(rbtree_pool *pool)
+{
+  if (--pool->refs > 0)
+    return;
+
+  // 노드는 모두 슬랩 안에 있으므로 슬랩 단위로 해제
+  rbtree_slab *slab = pool->slabs;
+  while (slab != NULL)
+  {
+    rbtree_slab *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  free(pool);
+}
+
+/// @brief 트리를 삭제하고 메모리 해제하는 함수
+/// @param t 삭제할 트리 포인터
+void delete_rbtree(rbtree *t) 
+{
+#ifdef RBTREE_NO_POOL
+  delete_node(t, t->root); // 루트부터 시작
+#else
+  // 풀을 혼자 쓰고 있으면 노드 순회 없이 풀과 함께 슬랩 단위로 해제, 공유 중이면 노드만 free list로 돌려줌
+  if (t->pool->refs > 1)
+    delete_node(t, t->root);
+#endif
+  rbtree_pool_release(t->pool); // 마지막 트리였다면 nil 노드도 함께 해제
+  free(t); // 트리 메모리 해제
+}
+
+#define RBTREE_MAX_HEIGHT 128  // 노드 수가 2^63 미만이면 높이는 2 log2(n + 1) < 128이므로 고정 크기 스택으로 충분
+
+/// @brief 서브트리의 모든 노드를 재귀 없이 삭제하고 키 수를 세는 함수 (고정 크기 스택으로 중위 순회)
+/// @param t 삭제할 트리 포인터
+/// @param node 삭제할 서브트리의 루트
+/// @return 삭제한 키 수 (RBTREE_MULTISET이면 같은 키의 개수 포함)
+/// @note 풀을 쓰면 노드를 지역 체인에 모았다가 마지막에 free list 앞에 한 번에 붙임
+///       (노드마다 free list에 넣거나 회전으로 떼어내면 2배 가까이 느림, bench-traverse)
+///       보조 스택 없이 순회하라는 요구와 달리 속도 때문에 일부러 높이만큼의 스택을 씀
+static size_t rbtree_free_subtree(rbtree *t, node_t *node)
+{
+  node_t *nil = t->nil; // 노드에 쓰는 값이 t->nil과 겹칠 수 있다고 보고 매번 다시 읽지 않도록
+  node_t *stack[RBTREE_MAX_HEIGHT]; // 아직 해제하지 않은 조상 (경로의 노드 수만큼만 쌓임)
+  size_t top = 0;
+  size_t count = 0;
+  node_t *cur;
+
+  for (cur = node; cur != nil; cur = cur->left) // 최소 노드까지 내려가며 조상을 쌓음
+  {
+    assert(top < RBTREE_MAX_HEIGHT); // 색 규칙이 깨진 트리면 스택을 넘을 수 있음
+    stack[top++] = cur;
+  }
+#ifndef RBTREE_NO_POOL
+  node_t *freed = NULL;                          // 해제한 노드 체인 (right로 연결, 나중에 해제한 노드가 앞)
+  node_t *tail = top > 0 ? stack[top - 1] : NULL; // 처음 해제하는 최소 노드가 체인의 끝
+  size_t nodes = 0;
+#endif
+
+  while (top > 0)
+  {
+    node_t *done = stack[--top]; // 왼쪽 서브트리는 이미 모두 해제됨
+    for (cur = done->right; cur != nil; cur = cur->left) // 해제하면 right가 덮어써지므로 먼저 내려감
+    {
+      assert(top < RBTREE_MAX_HEIGHT);
+      stack[top++] = cur;
+    }
+    count += rbtree_weight(done);
+#ifdef RBTREE_NO_POOL
+    rbtree_node_free(t, done);
+#else
+    done->right = freed;
+    freed = done;
+    nodes++;
+#endif
+  }
+
+#ifndef RBTREE_NO_POOL
+  if (freed != NULL)
+  {
+    tail->right = t->pool->free_list;
+    t->pool->free_list = freed;
+    rbtree_stat_add(t, frees, nodes);
+  }
+#endif
+  return count;
+}
+
+/// @brief 서브트리의 모든 노드를 재귀 없이 삭제하는 함수
+/// @param t 삭제할 트리 포인터
+/// @param node 삭제할 서브트리의 루트
+void delete_node(rbtree *t, node_t *node)
+{
+  rbtree_free_subtree(t, node);
+}
+
+/// @brief 노드 n개를 미리 할당해서 right 포인터로 연결한 체인을 만드는 함수
+/// @param t 노드를 할당할 트리 포인터
+/// @param n 할당할 노드 수
+/// @param chain 체인 머리 포인터 (할당한 노드를 앞에 이어 붙임)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (이번에 할당한 노드는 모두 반환)
+static int rbtree_alloc_chain(rbtree *t, size_t n, node_t **chain)
+{
+  node_t *head = *chain;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    node_t *node = rbtree_node_alloc(t);
+    if (node == NULL) // 실패하면 이번에 할당한 노드만 되돌려 놓음
+    {
+      while (head != *chain)
+      {
+        node_t *next = head->right;
+        rbtree_node_free(t, head);
+        head = next;
+      }
+      return -1;
+    }
+    node->right = head;
+    head = node;
+  }
+
+  *chain = head;
+  return 0;
+}
+
+/// @brief right 포인터로 연결된 체인의 노드를 모두 반환하는 함수
+/// @param t 노드가 속한 트리 포인터
+/// @param chain 체인 머리
+static void rbtree_free_chain(rbtree *t, node_t *chain)
+{
+  while (chain != NULL)
+  {
+    node_t *next = chain->right;
+    rbtree_node_free(t, chain);
+    chain = next;
+  }
+}
+
+/// @brief 서브트리의 모든 노드를 해제하지 않고 떼어내서 체인에 이어 붙이는 함수 (스택 없이 O(n))
+/// @param t 대상 트리 포인터
+/// @param node 떼어낼 서브트리의 루트
+/// @param chain 체인 머리 포인터
+static void rbtree_chain_subtree(rbtree *t, node_t *node, node_t **chain)
+{
+  node_t *cur = node;
+
+  while (cur != t->nil) // 왼쪽 자식이 있으면 오른쪽 회전으로 올리고, 없으면 현재 노드를 체인에 붙이고 오른쪽으로 이동
+  {
+    if (cur->left == t->nil)
+    {
+      node_t *next = cur->right;
+      cur->right = *chain;
+      *chain = cur;
+      cur = next;
+    }
+    else
+    {
+      node_t *left = cur->left;
+      cur->left = left->right;
+      left->right = cur;
+      cur = left;
+    }
+  }
+}
+
+/// @brief 정렬된 배열로 만드는 트리에서 빨간색으로 칠할 깊이를 구하는 함수
+/// @param n 노드 수
+/// @return 마지막 불완전 레벨의 깊이 = 꽉 찬 레벨의 수 = floor(log2(n + 1))
+static size_t rbtree_red_depth(size_t n)
+{
+  size_t red_depth = 0;
+  while (((size_t)2 << red_depth) - 1 <= n)
+    red_depth++;
+  return red_depth;
+}
+
+/// @brief 정렬된 배열로 만드는 서브트리의 루트 노드를 채우고 두 자식과 연결하는 함수
+/// @param t 대상 트리 포인터
+/// @param node 루트가 될 노드
+/// @param key 노드의 키
+/// @param count 같은 키의 개수 (RBTREE_MULTISET이 아니면 항상 1)
+/// @param left 왼쪽 서브트리 루트
+/// @param right 오른쪽 서브트리 루트
+/// @param red 빨간색으로 칠할지 여부
+static void rbtree_build_node(rbtree *t, node_t *node, key_t key, unsigned int count, node_t *left, node_t *right, int red)
+{
+  node->key = key;
+#ifdef RBTREE_MULTISET
+  node->count = count;
+#else
+  (void)count;
+#endif
+  rbtree_set_color(node, red ? RBTREE_RED : RBTREE_BLACK);
+  node->left = left;
+  node->right = right;
+  rbtree_set_parent(node, t->nil);
+#ifdef RBTREE_ORDER_STAT
+  node->size = left->size + right->size + count;
+#endif
+
+  if (left != t->nil)
+    rbtree_set_parent(left, node);
+  if (right != t->nil)
+    rbtree_set_parent(right, node);
+}
+
+/// @brief 정렬된 배열 구간으로 균형 잡힌 서브트리를 만드는 재귀 함수
+/// @param t 대상 트리 포인터
+/// @param nodes 미리 할당된 연속 노드 배열, NULL이면 chain에서 노드를 꺼내 사용
+/// @param chain 미리 할당된 노드 체인 (right 포인터로 연결)
+/// @param arr 오름차순으로 정렬된 키 배열
+/// @param counts 키마다 같은 키의 개수, NULL이면 모두 1
+/// @param lo 구간 시작 인덱스 (포함)
+/// @param hi 구간 끝 인덱스 (미포함)
+/// @param depth 서브트리 루트의 깊이
+/// @param red_depth 빨간색으로 칠할 깊이 (마지막 불완전 레벨)
+/// @return 서브트리 루트, 구간이 비었으면 nil
+static node_t *rbtree_build_sorted(rbtree *t, node_t *nodes, node_t **chain, const key_t *arr, const unsigned int *counts, size_t lo, size_t hi, size_t depth, size_t red_depth)
+{
+  if (lo >= hi) // 빈 구간이면 nil
+    return t->nil;
+
+  size_t mid = lo + (hi - lo) / 2; // 가운데 원소를 서브트리 루트로
+  node_t *node;
+  if (nodes != NULL)
+    node = &nodes[mid];
+  else // 체인 맨 앞의 노드를 꺼내 사용
+  {
+    node = *chain;
+    *chain = node->right;
+  }
+
+  node_t *left = rbtree_build_sorted(t, nodes, chain, arr, counts, lo, mid, depth + 1, red_depth);
+  node_t *right = rbtree_build_sorted(t, nodes, chain, arr, counts, mid + 1, hi, depth + 1, red_depth);
+
+  // 꽉 찬 레벨은 모두 검정, 마지막 불완전 레벨만 빨강 -> 모든 경로의 black height가 같음
+  rbtree_build_node(t, node, arr[mid], counts != NULL ? counts[mid] : 1, left, right, depth == red_depth);
+  return node;
+}
+
+/// @brief 만들어진 서브트리를 빈 트리 t의 루트로 설정하는 함수
+/// @param t 빈 트리 포인터
+/// @param root 정렬된 배열로 만든 서브트리 루트
+/// @param total 키 수 (같은 키의 개수 포함)
+static void rbtree_build_finish(rbtree *t, node_t *root, size_t total)
+{
+  t->root = root;
+  rbtree_set_color(t->root, RBTREE_BLACK);
+  t->count = total;
+
+  t->leftmost = rbtree_min_subtree(t, t->root);
+  t->rightmost = t->root;
+  while (t->rightmost->right != t->nil)
+    t->rightmost = t->rightmost->right;
+}
+
+/// @brief 빈 트리 t를 정렬된 키 배열로 채우는 함수 (O(n), 회전 없음)
+/// @param t 빈 트리 포인터
+/// @param arr 오름차순으로 정렬된 키 배열
+/// @param counts 키마다 같은 키의 개수, NULL이면 모두 1
+/// @param n 배열 크기 (만들 노드 수)
+/// @param total 키 수 (counts의 합)
+/// @param nodes 연속 노드 배열 (NULL이면 chain 사용)
+/// @param chain 노드 n개 이상이 연결된 체인
+static void rbtree_build(rbtree *t, const key_t *arr, const unsigned int *counts, size_t n, size_t total, node_t *nodes, node_t **chain)
+{
+  if (n == 0)
+    return;
+
+  rbtree_build_finish(t, rbtree_build_sorted(t, nodes, chain, arr, counts, 0, n, 0, rbtree_red_depth(n)), total);
+}
+
+/// @brief 키 순서로 정렬된 노드 포인터 배열 구간으로 균형 잡힌 서브트리를 만드는 재귀 함수 (키와 개수는 그대로 두고 링크와 색만 다시 설정)
+/// @param t 대상 트리 포인터
+/// @param nodes 키 오름차순으로 정렬된 노드 포인터 배열
+/// @param lo 구간 시작 인덱스 (포함)
+/// @param hi 구간 끝 인덱스 (미포함)
+/// @param depth 서브트리 루트의 깊이
+/// @param red_depth 빨간색으로 칠할 깊이 (마지막 불완전 레벨)
+/// @return 서브트리 루트, 구간이 비었으면 nil
+static node_t *rbtree_build_linked(rbtree *t, node_t **nodes, size_t lo, size_t hi, size_t depth, size_t red_depth)
+{
+  if (lo >= hi) // 빈 구간이면 nil
+    return t->nil;
+
+  size_t mid = lo + (hi - lo) / 2;
+  node_t *node = nodes[mid];
+  node_t *left = rbtree_build_linked(t, nodes, lo, mid, depth + 1, red_depth);
+  node_t *right = rbtree_build_linked(t, nodes, mid + 1, hi, depth + 1, red_depth);
+  rbtree_build_node(t, node, node->key, rbtree_weight(node), left, right, depth == red_depth);
+  return node;
+}
+
+#ifdef RBTREE_MULTISET
+/// @brief 정렬된 키 배열에서 같은 키가 이어진 구간을 키 하나와 개수로 합치는 함수
+/// @param arr 오름차순으로 정렬된 키 배열
+/// @param n 배열 크기
+/// @param keys 서로 다른 키를 저장할 배열 (arr와 같은 배열이어도 됨)
+/// @param counts 각 키의 개수를 저장할 배열
+/// @return 서로 다른 키의 수
+static size_t rbtree_collapse_keys(const key_t *arr, size_t n, key_t *keys, unsigned int *counts)
+{
+  size_t u = 0;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    if (u > 0 && keys[u - 1] == arr[i])
+      counts[u - 1]++;
+    else
+    {
+      keys[u] = arr[i];
+      counts[u++] = 1;
+    }
+  }
+
+  return u;
+}
+#endif
+
+#define RBTREE_PAR_GRAIN 8192  // 병렬 작업 하나가 처리할 최소 키 수
+
+// 병렬 bulk build 작업 하나: 정렬된 배열의 [lo, hi) 구간으로 서브트리를 만듦
+typedef struct {
+  rbtree_task task;
+  rbtree *t;
+  rbtree_workers *w;
+  node_t *nodes;  // 연속 노드 배열, NULL이면 작업마다 노드를 할당 (RBTREE_NO_POOL)
+  const key_t *arr;
+  const unsigned int *counts;  // 키마다 같은 키의 개수, NULL이면 모두 1
+  size_t lo, hi, depth, red_depth;
+  node_t *root;   // 결과 서브트리 루트, 메모리 할당 실패 시 NULL
+} rbtree_build_job;
+
+/// @brief 구간을 반으로 나눠 왼쪽은 다른 워커에게 넘기고 오른쪽은 직접 만드는 함수
+/// @param task rbtree_build_job의 task 멤버
+static void rbtree_build_job_run(rbtree_task *task)
+{
+  rbtree_build_job *job = rbtree_entry(task, rbtree_build_job, task);
+  rbtree *t = job->t;
+
+  if (job->hi - job->lo <= RBTREE_PAR_GRAIN) // 작은 구간은 순차로
+  {
+    node_t *chain = NULL;
+    if (job->nodes == NULL && rbtree_alloc_chain(t, job->hi - job->lo, &chain) != 0)
+    {
+      job->root = NULL;
+      return;
+    }
+    job->root = rbtree_build_sorted(t, job->nodes, &chain, job->arr, job->counts, job->lo, job->hi, job->depth, job->red_depth);
+    return;
+  }
+
+  size_t mid = job->lo + (job->hi - job->lo) / 2;
+  rbtree_build_job left = *job, right = *job;
+  left.hi = mid;
+  left.depth++;
+  right.lo = mid + 1;
+  right.depth++;
+
+  rbtree_task_spawn(job->w, &left.task);
+  rbtree_build_job_run(&right.task);
+  rbtree_task_wait(job->w, &left.task);
+
+  // 연속 배열이 없으면 (RBTREE_NO_POOL: calloc은 스레드 안전) 가운데 노드를 여기서 할당
+  node_t *node = job->nodes != NULL ? &job->nodes[mid] : rbtree_node_alloc(t);
+  if (left.root == NULL || right.root == NULL || node == NULL) // 한쪽이라도 실패하면 만든 노드를 모두 반환
+  {
+    if (left.root != NULL)
+      delete_node(t, left.root);
+    if (right.root != NULL)
+      delete_node(t, right.root);
+    if (node != NULL && job->nodes == NULL)
+      rbtree_node_free(t, node);
+    job->root = NULL;
+    return;
+  }
+
+  rbtree_build_node(t, node, job->arr[mid], job->counts != NULL ? job->counts[mid] : 1, left.root, right.root, job->depth == job->red_depth);
+  job->root = node;
+}
+
+/// @brief 빈 트리 t에 노드 n개를 할당해서 정렬된 키 배열로 채우는 함수
+/// @param t 빈 트리 포인터
+/// @param w 사용할 스레드 풀, NULL이면 순차로
+/// @param arr 오름차순으로 정렬된 키 배열
+/// @param counts 키마다 같은 키의 개수, NULL이면 모두 1
+/// @param n 배열 크기 (만들 노드 수)
+/// @param total 키 수 (counts의 합)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (할당한 노드는 트리의 풀에 남아 delete_rbtree로 해제됨)
+static int rbtree_build_keys(rbtree *t, rbtree_workers *w, const key_t *arr, const unsigned int *counts, size_t n, size_t total)
+{
+  node_t *nodes = NULL; // 풀을 쓰면 n개의 노드를 하나의 슬랩에 연속으로 할당
+  node_t *chain = NULL; // 풀이 없으면 노드를 하나씩 미리 할당해 둠 (병렬이면 작업마다)
+#ifndef RBTREE_NO_POOL
+  // 슬랩 하나에 연속으로 할당하면 병렬 작업끼리도 할당자를 공유하지 않음
+  nodes = rbtree_node_alloc_bulk(t, n);
+  if (nodes == NULL) // 메모리 할당 실패 시
+    return -1;
+#endif
+
+  if (w == NULL || n <= RBTREE_PAR_GRAIN || rbtree_workers_count(w) == 1) // 나눌 일이 없으면 순차로
+  {
+#ifdef RBTREE_NO_POOL
+    if (rbtree_alloc_chain(t, n, &chain) != 0) // 메모리 할당 실패 시
+      return -1;
+#endif
+    rbtree_build(t, arr, counts, n, total, nodes, &chain);
+    return 0;
+  }
+
+  rbtree_build_job job = {.t = t, .w = w, .nodes = nodes, .arr = arr, .counts = counts, .lo = 0, .hi = n, .depth = 0, .red_depth = rbtree_red_depth(n)};
+  job.task.fn = rbtree_build_job_run;
+  rbtree_workers_run(w, &job.task);
+  if (job.root == NULL) // 메모리 할당 실패 시
+    return -1;
+
+  rbtree_build_finish(t, job.root, total);
+  return 0;
+}
+
+/// @brief rbtree_from_sorted와 rbtree_from_sorted_par의 공통 처리
+/// @param w 사용할 스레드 풀, NULL이면 순차로
+/// @param arr 오름차순으로 정렬된 키 배열 (중복 허용)
+/// @param n 배열 크기
+/// @return 생성된 트리 포인터, 메모리 할당 실패 시 NULL
+static rbtree *rbtree_from_sorted_with(rbtree_workers *w, const key_t *arr, size_t n)
+{
+  rbtree *t = new_rbtree();
+  if (t == NULL || n == 0)
+    return t;
+
+#ifdef RBTREE_MULTISET
+  // 같은 키가 이어진 구간은 노드 하나로 합쳐서 만듦
+  key_t *keys = (key_t *)malloc(n * sizeof(key_t));
+  unsigned int *counts = (unsigned int *)malloc(n * sizeof(unsigned int));
+  int ret = -1;
+  if (keys != NULL && counts != NULL)
+    ret = rbtree_build_keys(t, w, keys, counts, rbtree_collapse_keys(arr, n, keys, counts), n);
+  free(keys);
+  free(counts);
+#else
+  int ret = rbtree_build_keys(t, w, arr, NULL, n, n);
+#endif
+
+  if (ret != 0) // 메모리 할당 실패 시
+  {
+    delete_rbtree(t);
+    return NULL;
+  }
+  return t;
+}
+
+/// @brief 정렬된 키 배열로부터 레드블랙트리를 O(n)에 생성하는 함수 (회전 없음)
+/// @param arr 오름차순으로 정렬된 키 배열 (중복 허용)
+/// @param n 배열 크기
+/// @return 생성된 트리 포인터, 메모리 할당 실패 시 NULL
+rbtree *rbtree_from_sorted(const key_t *arr, const size_t n)
+{
+  return rbtree_from_sorted_with(NULL, arr, n);
+}
+
+/// @brief rbtree_from_sorted의 병렬 버전 (구간을 반씩 나눠 워커들이 서브트리를 동시에 만듦)
+/// @param w 사용할 스레드 풀
+/// @param arr 오름차순으로 정렬된 키 배열 (중복 허용)
+/// @param n 배열 크기
+/// @return 생성된 트리 포인터, 메모리 할당 실패 시 NULL
+rbtree *rbtree_from_sorted_par(rbtree_workers *w, const key_t *arr, const size_t n)
+{
+  return rbtree_from_sorted_with(w, arr, n);
+}
+
+// rbtree_compact에서 노드를 새 위치로 옮기는 상태
+typedef struct {
+  node_t *nodes;  // 옮겨 갈 연속 노드 배열 (RBTREE_NO_POOL이면 NULL)
+  node_t *chain;  // RBTREE_NO_POOL이면 미리 할당해 둔 노드 체인
+  size_t next;    // nodes에서 다음에 채울 위치
+  node_t *nil;
+} rbtree_compact_ctx;
+
+/// @brief 서브트리의 높이와 노드 수를 구하는 함수
+/// @param t 대상 트리 포인터
+/// @param node 서브트리 루트
+/// @param nodes 노드 수를 더해 갈 포인터
+/// @return 서브트리의 높이 (nil이면 0)
+static size_t rbtree_subtree_height(const rbtree *t, const node_t *node, size_t *nodes)
+{
+  if (node == t->nil)
+    return 0;
+
+  (*nodes)++;
+  size_t left = rbtree_subtree_height(t, node->left, nodes);
+  size_t right = rbtree_subtree_height(t, node->right, nodes);
+  return (left > right ? left : right) + 1;
+}
+
+/// @brief 노드 하나를 다음 새 위치로 복사하고, 옛 노드의 부모 포인터 자리에 새 위치를 남기는 함수
+/// @param ctx 옮기는 상태
+/// @param node 옮길 노드 (left, right는 그대로 남으므로 이후에도 옛 트리를 따라 내려갈 수 있음)
+static void rbtree_compact_emit(rbtree_compact_ctx *ctx, node_t *node)
+{
+  node_t *copy;
+  if (ctx->nodes != NULL)
+    copy = &ctx->nodes[ctx->next++];
+  else
+  {
+    copy = ctx->chain;
+    ctx->chain = copy->right;
+  }
+
+  *copy = *node;
+  rbtree_set_parent(node, copy);
+}
+
+static void rbtree_compact_veb(rbtree_compact_ctx *ctx, node_t *node, size_t height);
+
+/// @brief 서브트리에서 depth 깊이에 있는 노드들을 왼쪽부터 vEB 순서로 옮기는 함수
+/// @param ctx 옮기는 상태
+/// @param node 서브트리 루트
+/// @param depth 옮길 노드들의 깊이 (node가 0)
+/// @param height 옮길 노드마다 배치할 높이
+static void rbtree_compact_veb_bottom(rbtree_compact_ctx *ctx, node_t *node, size_t depth, size_t height)
+{
+  if (node == ctx->nil)
+    return;
+
+  if (depth == 0)
+  {
+    rbtree_compact_veb(ctx, node, height);
+    return;
+  }
+  rbtree_compact_veb_bottom(ctx, node->left, depth - 1, height);
+  rbtree_compact_veb_bottom(ctx, node->right, depth - 1, height);
+}
+
+/// @brief 서브트리의 위쪽 height 레벨을 van Emde Boas 순서로 옮기는 함수
+/// @param ctx 옮기는 상태
+/// @param node 서브트리 루트
+/// @param height 배치할 레벨 수 (위쪽 절반을 먼저 배치하고, 그 아래 서브트리들을 차례로 배치)
+static void rbtree_compact_veb(rbtree_compact_ctx *ctx, node_t *node, size_t height)
+{
+  if (node == ctx->nil)
+    return;
+
+  if (height == 1)
+  {
+    rbtree_compact_emit(ctx, node);
+    return;
+  }
+
+  size_t top = height / 2;
+  rbtree_compact_veb(ctx, node, top);
+  rbtree_compact_veb_bottom(ctx, node, top, height - top);
+}
+
+/// @brief 옮긴 노드의 자식 포인터를 새 위치로 바꾸고 옛 자식 노드를 반환하는 함수
+/// @param t 대상 트리 포인터
+/// @param node 새 위치의 노드 (자식 포인터는 아직 옛 노드를 가리킴)
+/// @param release 옛 노드를 하나씩 반환할지 여부 (0이면 호출한 쪽이 슬랩째 해제)
+static void rbtree_compact_link(rbtree *t, node_t *node, int release)
+{
+  node_t *left = node->left;
+  node_t *right = node->right;
+
+  if (left != t->nil)
+  {
+    node->left = rbtree_parent(left); // 옛 노드에 남겨 둔 새 위치
+    rbtree_set_parent(node->left, node);
+    if (release)
+      rbtree_node_free(t, left);
+    rbtree_compact_link(t, node->left, release);
+  }
+  if (right != t->nil)
+  {
+    node->right = rbtree_parent(right);
+    rbtree_set_parent(node->right, node);
+    if (release)
+      rbtree_node_free(t, right);
+    rbtree_compact_link(t, node->right, release);
+  }
+}
+
+/// @brief 흩어진 노드를 van Emde Boas 순서로 하나의 연속 영역에 다시 배치하는 함수 (O(n log log n))
+/// @param t 대상 트리 포인터 (이후에도 그대로 삽입 / 삭제 가능)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (트리는 바뀌지 않음)
+/// @note 노드 주소가 모두 바뀌므로 이전에 받은 노드 포인터와 커서는 쓸 수 없음,
+///       rbtree_insert_node로 넣은 노드처럼 트리가 할당하지 않은 노드가 있으면 사용하면 안 됨
+/// @note RBTREE_NO_POOL이면 노드를 하나씩 새로 할당해 옮기므로 연속성은 할당자에 달려 있음
+int rbtree_compact(rbtree *t)
+{
+  if (t->root == t->nil) // 빈 트리면 할 일이 없음
+    return 0;
+
+  size_t n = 0;
+  size_t height = rbtree_subtree_height(t, t->root, &n);
+
+  rbtree_compact_ctx ctx = {.nodes = NULL, .chain = NULL, .next = 0, .nil = t->nil};
+  int release = 1;
+#ifdef RBTREE_NO_POOL
+  if (rbtree_alloc_chain(t, n, &ctx.chain) != 0) // 메모리 할당 실패 시
+    return -1;
+#else
+  ctx.nodes = rbtree_node_alloc_bulk(t, n);
+  if (ctx.nodes == NULL) // 메모리 할당 실패 시
+    return -1;
+  release = t->pool->refs > 1; // 풀을 혼자 쓰면 옛 슬랩을 통째로 해제
+#endif
+
+  rbtree_compact_veb(&ctx, t->root, height);
+
+  // 옛 노드가 살아 있는 동안 새 위치를 읽어 둠
+  node_t *root = rbtree_parent(t->root);
+  node_t *old_root = t->root;
+  t->leftmost = rbtree_parent(t->leftmost);
+  t->rightmost = rbtree_parent(t->rightmost);
+  t->root = root;
+  rbtree_set_parent(root, t->nil);
+  if (release)
+    rbtree_node_free(t, old_root);
+  rbtree_compact_link(t, root, release);
+
+#ifndef RBTREE_NO_POOL
+  if (!release)
+  {
+    // 트리의 노드는 모두 새 슬랩에 있으므로 나머지 슬랩과 free list를 버림
+    rbtree_pool *pool = t->pool;
+    rbtree_slab *slab = pool->slabs;
+    rbtree_slab *keep = NULL;
+    while (slab != NULL)
+    {
+      rbtree_slab *next = slab->next;
+      if (slab->nodes == ctx.nodes)
+        keep = slab;
+      else
+        free(slab);
+      slab = next;
+    }
+    keep->next = NULL;
+    pool->slabs = keep;
+    pool->free_list = NULL;
+    rbtree_stat_add(t, frees, n);
+  }
+#endif
+  return 0;
+}
+
+#define RBTREE_BATCH_SMALL 32   // 이보다 작은 배치는 삽입 정렬
+#define RBTREE_BATCH_REBUILD 2  // 배치가 트리 크기의 1/2 이상이면 병합 후 재구성
+
+/// @brief 키 배열을 오름차순으로 삽입 정렬하는 함수
+/// @param keys 정렬할 키 배열
+/// @param n 배열 크기
+static void rbtree_insertion_sort(key_t *keys, size_t n)
+{
+  for (size_t i = 1; i < n; i++)
+  {
+    key_t key = keys[i];
+    size_t j = i;
+    for (; j > 0 && keys[j - 1] > key; j--)
+      keys[j] = keys[j - 1];
+    keys[j] = key;
+  }
+}
+
+/// @brief 키 배열을 오름차순으로 정렬하는 함수 (8비트씩 4번 도는 LSD 기수 정렬, O(n))
+/// @param keys 정렬할 키 배열 (제자리에서 정렬됨)
+/// @param n 배열 크기
+static void rbtree_sort_keys(key_t *keys, size_t n)
+{
+  if (n < RBTREE_BATCH_SMALL) // 작은 배열은 삽입 정렬이 더 빠름
+  {
+    rbtree_insertion_sort(keys, n);
+    return;
+  }
+
+  key_t *tmp = (key_t *)malloc(n * sizeof(key_t));
+  if (tmp == NULL) // 임시 버퍼가 없으면 삽입 정렬로 (느리지만 올바름)
+  {
+    rbtree_insertion_sort(keys, n);
+    return;
+  }
+
+  const unsigned int sign = ~(~0u >> 1); // 부호 비트를 뒤집으면 부호 없는 비교 순서가 부호 있는 순서와 같아짐
+  key_t *src = keys, *dst = tmp;
+
+  for (unsigned int shift = 0; shift < sizeof(key_t) * 8; shift += 8)
+  {
+    size_t count[257] = {0};
+
+    for (size_t i = 0; i < n; i++)
+      count[((((unsigned int)src[i] ^ sign) >> shift) & 0xff) + 1]++;
+    for (size_t b = 0; b < 256; b++) // 누적합으로 각 버킷의 시작 위치 계산
+      count[b + 1] += count[b];
+    for (size_t i = 0; i < n; i++)
+      dst[count[(((unsigned int)src[i] ^ sign) >> shift) & 0xff]++] = src[i];
+
+    key_t *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  // 4번(짝수 번) 돌았으므로 결과는 다시 keys에 있음
+
+  free(tmp);
+}
+
+/// @brief 키 배열을 한 번에 삽입하는 함수 (정렬 후 병합)
+/// @param t 삽입할 트리 포인터
+/// @param keys 삽입할 키 배열 (오름차순으로 제자리 정렬됨)
+/// @param n 배열 크기
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (트리는 바뀌지 않음)
+/// @note 배치가 작으면 직전에 삽입한 노드에서 위로 올라간 뒤 내려가는 finger 삽입으로 O(m log(n/m)),
+///       배치가 크면 기존 노드와 배치 키를 담은 새 노드를 키 순서로 병합해 링크만 다시 연결 O(n + m)
+///       어느 쪽이든 기존 노드의 주소와 키는 그대로이므로 rbtree_insert_node로 넣은 노드가 있어도 됨
+int rbtree_insert_batch(rbtree *t, key_t *keys, size_t n)
+{
+  if (n == 0)
+    return 0;
+
+  // 필요한 노드를 먼저 모두 할당해 두면 중간에 실패해서 일부만 삽입되는 일이 없음
+  node_t *chain = NULL;
+  if (rbtree_alloc_chain(t, n, &chain) != 0)
+    return -1;
+
+  rbtree_sort_keys(keys, n);
+
+  size_t total = rbtree_size(t) + n;
+  node_t **merged = NULL; // 기존 노드와 새 노드를 키 순서로 병합한 배열
+  if (n * RBTREE_BATCH_REBUILD >= t->count) // 큰 배치는 재구성 (버퍼 할당에 실패하면 finger 삽입으로)
+    merged = (node_t **)malloc(total * sizeof(node_t *));
+
+  if (merged != NULL)
+  {
+    size_t old = 0;
+    for (node_t *cur = t->leftmost; cur != t->nil && cur != NULL; cur = rbtree_next(t, cur))
+      merged[old++] = cur;
+
+    // 뒤에서부터 병합하면 추가 버퍼 없이 merged 안에서 끝남 (같은 키는 기존 노드가 앞쪽)
+    size_t i = old, j = n, k = old + n;
+#ifdef RBTREE_MULTISET
+    node_t *fresh = NULL; // 마지막으로 놓은 새 노드, 같은 키는 새 노드를 만들지 않고 개수로 합침
+#endif
+    while (i > 0 || j > 0)
+    {
+      if (j == 0 || (i > 0 && merged[i - 1]->key > keys[j - 1])) // 기존 노드
+      {
+        node_t *node = merged[--i];
+#ifdef RBTREE_MULTISET
+        if (fresh != NULL && merged[k] == fresh && fresh->key == node->key) // 같은 키의 새 노드를 기존 노드에 합침
+        {
+          node->count += fresh->count;
+          fresh->right = chain;
+          chain = fresh;
+          fresh = NULL;
+          merged[k] = node;
+          continue;
+        }
+#endif
+        merged[--k] = node;
+        continue;
+      }
+
+      key_t key = keys[--j];
+#ifdef RBTREE_MULTISET
+      if (fresh != NULL && fresh->key == key)
+      {
+        fresh->count++;
+        continue;
+      }
+#endif
+      node_t *node = chain;
+      chain = node->right;
+      node->key = key;
+#ifdef RBTREE_MULTISET
+      node->count = 1;
+      fresh = node;
+#endif
+      merged[--k] = node;
+    }
+
+    size_t m = old + n - k; // 만들 트리의 노드 수
+    rbtree_build_finish(t, rbtree_build_linked(t, merged + k, 0, m, 0, rbtree_red_depth(m)), total);
+    free(merged);
+    rbtree_free_chain(t, chain);
+    return 0;
+  }
+
+  node_t *finger = t->nil; // 직전에 삽입한 노드 (키가 정렬되어 있으므로 다음 위치는 항상 그 뒤쪽)
+  for (size_t i = 0; i < n; i++)
+  {
+    node_t *cur = t->root;
+    if (finger != t->nil)
+    {
+      // finger의 서브트리 상한(처음으로 왼쪽 자식으로 매달린 조상의 키)이 key보다 커질 때까지 올라감
+      cur = finger;
+      for (node_t *parent = rbtree_parent(cur); parent != t->nil; parent = rbtree_parent(cur))
+      {
+        if (cur == parent->left && keys[i] < parent->key)
+          break;
+        cur = parent;
+      }
+    }
+
+    node_t *parent = t->nil;
+    node_t **link = &t->root;
+    while (cur != t->nil) // 올라간 위치부터 일반 삽입처럼 내려감
+    {
+#ifdef RBTREE_MULTISET
+      if (keys[i] == cur->key) // 같은 키가 있으면 개수만 증가
+        break;
+#endif
+      parent = cur;
+      link = keys[i] < cur->key ? &cur->left : &cur->right;
+      cur = *link;
+    }
+
+#ifdef RBTREE_MULTISET
+    if (cur != t->nil)
+    {
+      rbtree_add_count(t, cur, 1);
+      finger = cur;
+      continue;
+    }
+#endif
+
+    node_t *node = chain;
+    chain = node->right;
+    node->key = keys[i];
+    rbtree_link_node(t, node, parent, link);
+    rbtree_insert_fixup(t, node);
+    finger = node;
+  }
+
+  rbtree_free_chain(t, chain);
+  return 0;
+}
+
+// split / join 중간 결과: 부모가 nil인 서브트리와 그 black height
+typedef struct {
+  node_t *root;
+  size_t bh;  // 루트에서 nil까지 경로의 검은 노드 수 (루트 포함, nil 제외)
+} rbtree_part;
+
+/// @brief 서브트리의 black height를 구하는 함수 (O(log n))
+/// @param t 대상 트리 포인터
+/// @param root 서브트리 루트
+/// @return 루트부터 왼쪽 끝까지 검은 노드 수
+static size_t rbtree_black_height(const rbtree *t, const node_t *root)
+{
+  size_t bh = 0;
+  for (; root != t->nil; root = root->left)
+    if (rbtree_color(root) == RBTREE_BLACK)
+      bh++;
+  return bh;
+}
+
+/// @brief 자식 서브트리를 부모에서 떼어내 독립된 서브트리로 만드는 함수
+/// @param t 대상 트리 포인터
+/// @param child 떼어낼 자식 (nil 가능)
+/// @param bh 자식의 black height
+/// @return 떼어낸 서브트리
+static rbtree_part rbtree_detach_part(rbtree *t, node_t *child, size_t bh)
+{
+  if (child != t->nil)
+    rbtree_set_parent(child, t->nil);
+  return (rbtree_part){child, bh};
+}
+
+/// @brief l의 모든 키 <= k의 키 <= r의 모든 키일 때 세 부분을 하나의 서브트리로 합치는 함수 (O(|bh(l) - bh(r)| + 1))
+/// @param t 대상 트리 포인터 (nil만 사용)
+/// @param l 왼쪽 서브트리
+/// @param k 가운데 노드
+/// @param r 오른쪽 서브트리
+/// @return 합친 서브트리 (루트는 검정)
+static rbtree_part rbtree_join_parts(rbtree *t, rbtree_part l, node_t *k, rbtree_part r)
+{
+  // 양쪽 루트를 검게 칠해 두면 (black height는 1 증가) k를 끼운 자리 위쪽의 red-red 위반만 고치면 됨
+  if (rbtree_color(l.root) == RBTREE_RED)
+  {
+    rbtree_set_color(l.root, RBTREE_BLACK);
+    l.bh++;
+  }
+  if (rbtree_color(r.root) == RBTREE_RED)
+  {
+    rbtree_set_color(r.root, RBTREE_BLACK);
+    r.bh++;
+  }
+
+  // black height가 같으면 k를 검은 루트로 올리면 끝
+  if (l.bh == r.bh)
+  {
+    rbtree_set_color(k, RBTREE_BLACK);
+    rbtree_set_parent(k, t->nil);
+    k->left = l.root;
+    k->right = r.root;
+    if (l.root != t->nil)
+      rbtree_set_parent(l.root, k);
+    if (r.root != t->nil)
+      rbtree_set_parent(r.root, k);
+#ifdef RBTREE_ORDER_STAT
+    k->size = l.root->size + r.root->size + rbtree_weight(k);
+#endif
+    return (rbtree_part){k, l.bh + 1};
+  }
+
+  // 높은 쪽 척추를 따라 내려가서 black height가 낮은 쪽과 같은 검은 노드 cur를 찾고, 그 자리에 빨간 k를 끼움
+  rbtree sub = *t; // 회전이 루트를 바꿀 수 있으므로 임시 트리로 감싸서 밸런싱
+  node_t *parent = t->nil;
+  node_t *cur;
+  size_t bh;
+#ifdef RBTREE_ORDER_STAT
+  unsigned int added; // 척추 위쪽 노드들에 더해지는 키 수
+#endif
+
+  if (l.bh > r.bh) // l의 오른쪽 척추에 r을 붙임
+  {
+    cur = l.root;
+    for (bh = l.bh; bh > r.bh || rbtree_color(cur) == RBTREE_RED; cur = cur->right)
+    {
+      if (rbtree_color(cur) == RBTREE_BLACK)
+        bh--;
+      parent = cur;
+    }
+    k->left = cur;
+    k->right = r.root;
+    parent->right = k;
+    sub.root = l.root;
+    bh = l.bh;
+#ifdef RBTREE_ORDER_STAT
+    added = r.root->size + rbtree_weight(k);
+#endif
+  }
+  else // r의 왼쪽 척추에 l을 붙임 (대칭)
+  {
+    cur = r.root;
+    for (bh = r.bh; bh > l.bh || rbtree_color(cur) == RBTREE_RED; cur = cur->left)
+    {
+      if (rbtree_color(cur) == RBTREE_BLACK)
+        bh--;
+      parent = cur;
+    }
+    k->left = l.root;
+    k->right = cur;
+    parent->left = k;
+    sub.root = r.root;
+    bh = r.bh;
+#ifdef RBTREE_ORDER_STAT
+    added = l.root->size + rbtree_weight(k);
+#endif
+  }
+
+  rbtree_set_color(k, RBTREE_RED);
+  rbtree_set_parent(k, parent);
+  if (k->left != t->nil)
+    rbtree_set_parent(k->left, k);
+  if (k->right != t->nil)
+    rbtree_set_parent(k->right, k);
+#ifdef RBTREE_ORDER_STAT
+  k->size = k->left->size + k->right->size + rbtree_weight(k);
+  for (node_t *p = parent; p != t->nil; p = rbtree_parent(p))
+    p->size += added;
+#endif
+
+  rbtree_insert_rebalance(&sub, k);
+  if (rbtree_color(sub.root) == RBTREE_RED) // 위반이 루트까지 올라왔으면 루트를 검게 (black height 1 증가)
+  {
+    rbtree_set_color(sub.root, RBTREE_BLACK);
+    bh++;
+  }
+  return (rbtree_part){sub.root, bh};
+}
+
+/// @brief 서브트리에서 최대 노드를 떼어내는 함수 (O(log n))
+/// @param t 대상 트리 포인터
+/// @param p 비어 있지 않은 서브트리
+/// @param last 떼어낸 최대 노드를 저장할 포인터
+/// @return 최대 노드를 뺀 서브트리
+static rbtree_part rbtree_split_last(rbtree *t, rbtree_part p, node_t **last)
+{
+  node_t *x = p.root;
+  size_t bh = p.bh - (rbtree_color(x) == RBTREE_BLACK);
+  rbtree_part l = rbtree_detach_part(t, x->left, bh);
+
+  if (x->right == t->nil) // x가 최대 노드
+  {
+    *last = x;
+    return l;
+  }
+
+  rbtree_part rest = rbtree_split_last(t, rbtree_detach_part(t, x->right, bh), last);
+  return rbtree_join_parts(t, l, x, rest);
+}
+
+/// @brief 가운데 노드 없이 두 서브트리를 합치는 함수 (l의 최대 노드를 가운데 노드로 사용)
+/// @param t 대상 트리 포인터
+/// @param l 왼쪽 서브트리
+/// @param r 오른쪽 서브트리
+/// @return 합친 서브트리
+static rbtree_part rbtree_join2_parts(rbtree *t, rbtree_part l, rbtree_part r)
+{
+  if (l.root == t->nil)
+    return r;
+
+  node_t *k;
+  l = rbtree_split_last(t, l, &k);
+  return rbtree_join_parts(t, l, k, r);
+}
+
+/// @brief 서브트리를 key 기준으로 둘로 나누는 함수 (O(log n))
+/// @param t 대상 트리 포인터
+/// @param p 나눌 서브트리
+/// @param key 기준 키
+/// @param removed NULL이면 key와 같은 노드는 hi로 (lo < key <= hi),
+///                아니면 key와 같은 노드를 떼어내 right로 연결된 이 체인에 모음 (lo < key < hi)
+/// @param lo key보다 작은 키의 서브트리를 저장할 포인터
+/// @param hi 나머지 서브트리를 저장할 포인터
+static void rbtree_split_part(rbtree *t, rbtree_part p, const key_t key, node_t **removed, rbtree_part *lo, rbtree_part *hi)
+{
+  node_t *x = p.root;
+  if (x == t->nil)
+  {
+    *lo = *hi = (rbtree_part){t->nil, 0};
+    return;
+  }
+
+  size_t bh = p.bh - (rbtree_color(x) == RBTREE_BLACK);
+  rbtree_part l = rbtree_detach_part(t, x->left, bh);
+  rbtree_part r = rbtree_detach_part(t, x->right, bh);
+  rbtree_part mid;
+
+  if (removed != NULL && x->key == key) // 같은 키는 양쪽 서브트리에 모두 있을 수 있으므로 둘 다 나눔 (mid는 비어 있음)
+  {
+    rbtree_split_part(t, l, key, removed, lo, &mid);
+    rbtree_split_part(t, r, key, removed, &mid, hi);
+    x->right = *removed;
+    *removed = x;
+  }
+  else if (key <= x->key) // x는 hi 쪽, 경계는 왼쪽 서브트리 안에 있음
+  {
+    rbtree_split_part(t, l, key, removed, lo, &mid);
+    *hi = rbtree_join_parts(t, mid, x, r);
+  }
+  else // x는 lo 쪽, 경계는 오른쪽 서브트리 안에 있음
+  {
+    rbtree_split_part(t, r, key, removed, &mid, hi);
+    *lo = rbtree_join_parts(t, l, x, mid);
+  }
+}
+
+#ifndef RBTREE_MULTISET
+/// @brief 서브트리의 한쪽 끝에 모여 있는 key와 같은 노드들을 떼어내는 함수
+/// @param t 대상 트리 포인터
+/// @param p 대상 서브트리 (from_max면 모든 키 <= key, 아니면 모든 키 >= key)
+/// @param key 떼어낼 키
+/// @param from_max 1이면 최대 쪽 끝, 0이면 최소 쪽 끝에서 떼어냄
+/// @param removed 떼어낸 노드를 right로 연결해 모을 체인
+/// @return 나머지 서브트리
+/// @note 끝 노드의 키부터 확인하므로 같은 키가 없으면 척추만 훑고 트리는 건드리지 않음
+static rbtree_part rbtree_peel_equal(rbtree *t, rbtree_part p, const key_t key, const int from_max, node_t **removed)
+{
+  node_t *edge = p.root;
+  if (edge == t->nil)
+    return p;
+  while ((from_max ? edge->right : edge->left) != t->nil)
+    edge = from_max ? edge->right : edge->left;
+  if (edge->key != key)
+    return p;
+
+  rbtree_part lo, hi;
+  rbtree_split_part(t, p, key, removed, &lo, &hi);
+  return from_max ? lo : hi; // 반대쪽은 비어 있음
+}
+#endif
+
+// 집합 연산 종류
+typedef enum { RBTREE_SET_UNION, RBTREE_SET_INTERSECTION, RBTREE_SET_DIFFERENCE } rbtree_set_kind;
+
+// 집합 연산 전체에서 공유하는 상태
+typedef struct {
+  rbtree *t;
+  rbtree_set_kind kind;
+  rbtree_workers *w;                     // NULL이면 순차 실행
+  size_t par_depth;                      // 이 깊이까지만 재귀 호출을 다른 워커에게 넘김
+  node_t *removed[RBTREE_WORKERS_MAX];   // 워커별로 모으는 버릴 노드 체인 (right로 연결)
+} rbtree_set_ctx;
+
+// 다른 워커에게 넘기는 집합 연산 재귀 호출 하나
+typedef struct {
+  rbtree_task task;
+  rbtree_set_ctx *ctx;
+  rbtree_part a, b, result;
+  size_t depth;
+} rbtree_set_job;
+
+static rbtree_part rbtree_set_parts(rbtree_set_ctx *ctx, rbtree_part a, rbtree_part b, size_t depth);
+
+/// @brief rbtree_set_job을 실행하는 워커 함수
+/// @param task rbtree_set_job의 task 멤버
+static void rbtree_set_job_run(rbtree_task *task)
+{
+  rbtree_set_job *job = rbtree_entry(task, rbtree_set_job, task);
+  job->result = rbtree_set_parts(job->ctx, job->a, job->b, job->depth);
+}
+
+/// @brief 집합 연산 재귀 함수: a의 루트 키로 b를 나눈 뒤 양쪽을 따로 계산하고 다시 합침
+/// @param ctx 연산 상태
+/// @param a 기준 서브트리
+/// @param b 상대 서브트리 (a와 같은 풀)
+/// @param depth 재귀 깊이
+/// @return 결과 서브트리
+/// @note 합집합은 a의 노드를 모두 남기고 a에 있는 키와 같은 b의 노드를 버림,
+///       교집합은 b에 같은 키가 있는 a의 노드만, 차집합은 b에 같은 키가 없는 a의 노드만 남김 (중복 키도 키 단위로 판단)
+///       RBTREE_MULTISET이면 같은 키의 개수를 합집합은 큰 쪽, 교집합은 작은 쪽으로 하고, 차집합은 빼서 0이 된 노드만 버림
+static rbtree_part rbtree_set_parts(rbtree_set_ctx *ctx, rbtree_part a, rbtree_part b, size_t depth)
+{
+  rbtree *t = ctx->t;
+  // 한 작업은 한 스레드에서만 실행되므로 현재 워커의 체인을 그대로 써도 됨
+  node_t **removed = &ctx->removed[ctx->w != NULL ? rbtree_workers_self(ctx->w) : 0];
+
+  if (a.root == t->nil) // a가 비었으면 합집합은 b, 나머지는 b를 모두 버림
+  {
+    if (ctx->kind == RBTREE_SET_UNION)
+      return b;
+    rbtree_chain_subtree(t, b.root, removed);
+    return a;
+  }
+  if (b.root == t->nil) // b가 비었으면 교집합만 a를 모두 버림
+  {
+    if (ctx->kind != RBTREE_SET_INTERSECTION)
+      return a;
+    rbtree_chain_subtree(t, a.root, removed);
+    return b;
+  }
+
+  node_t *x = a.root;
+  size_t bh = a.bh - (rbtree_color(x) == RBTREE_BLACK);
+  rbtree_part l = rbtree_detach_part(t, x->left, bh);
+  rbtree_part r = rbtree_detach_part(t, x->right, bh);
+  rbtree_part bl, br;
+  node_t *before = *removed;
+  rbtree_split_part(t, b, x->key, removed, &bl, &br);
+#ifdef RBTREE_MULTISET
+  // 재귀 호출이 체인에 노드를 더 붙이기 전에 떼어낸 노드들의 개수를 x에 반영
+  unsigned int other = 0;
+  for (node_t *cur = *removed; cur != before; cur = cur->right)
+    other += cur->count;
+  if (ctx->kind == RBTREE_SET_UNION)
+    x->count = x->count > other ? x->count : other;
+  else if (ctx->kind == RBTREE_SET_INTERSECTION)
+    x->count = x->count < other ? x->count : other;
+  else
+    x->count = x->count > other ? x->count - other : 0;
+#else
+  int found = *removed != before; // b에서 x와 같은 키를 떼어냈는지
+  // b의 같은 키는 방금 모두 떼어냈으므로 a에 남은 같은 키(l의 최대 쪽, r의 최소 쪽 끝)도 여기서 x와 같이 처리
+  // 차집합은 바로 버리고, 교집합은 떼어 뒀다가 x 옆에 다시 붙임 (합집합은 a의 노드를 모두 남기므로 할 일 없음)
+  node_t *dups = NULL;
+  if (found && ctx->kind != RBTREE_SET_UNION)
+  {
+    node_t **sink = ctx->kind == RBTREE_SET_DIFFERENCE ? removed : &dups;
+    l = rbtree_peel_equal(t, l, x->key, 1, sink);
+    r = rbtree_peel_equal(t, r, x->key, 0, sink);
+  }
+#endif
+
+  // 두 재귀 호출은 서로 다른 노드만 건드리므로 왼쪽은 다른 워커에게 넘길 수 있음
+  if (ctx->w != NULL && depth < ctx->par_depth)
+  {
+    rbtree_set_job job = {.ctx = ctx, .a = l, .b = bl, .depth = depth + 1};
+    job.task.fn = rbtree_set_job_run;
+    rbtree_task_spawn(ctx->w, &job.task);
+    r = rbtree_set_parts(ctx, r, br, depth + 1);
+    rbtree_task_wait(ctx->w, &job.task);
+    l = job.result;
+  }
+  else
+  {
+    l = rbtree_set_parts(ctx, l, bl, depth + 1);
+    r = rbtree_set_parts(ctx, r, br, depth + 1);
+  }
+
+#ifdef RBTREE_MULTISET
+  int keep = x->count > 0;
+#else
+  int keep = ctx->kind == RBTREE_SET_UNION || (ctx->kind == RBTREE_SET_INTERSECTION) == found;
+#endif
+  if (keep)
+  {
+#ifndef RBTREE_MULTISET
+    for (node_t *next; dups != NULL; dups = next) // 떼어 둔 같은 키 노드를 x 바로 왼쪽에 붙임
+    {
+      next = dups->right;
+      l = rbtree_join_parts(t, l, dups, (rbtree_part){t->nil, 0});
+    }
+#endif
+    return rbtree_join_parts(t, l, x, r);
+  }
+
+  x->right = *removed;
+  *removed = x;
+  return rbtree_join2_parts(t, l, r);
+}
+
+/// @brief 서브트리 결과로 트리 t의 내용을 설정하는 함수 (루트 색, 최소 / 최대 캐시, 노드 수 갱신)
+/// @param t 대상 트리 포인터
+/// @param p 트리가 될 서브트리
+/// @param count 노드 수 (모르면 RBTREE_COUNT_UNKNOWN)
+static void rbtree_set_part(rbtree *t, rbtree_part p, size_t count)
+{
+  t->root = p.root;
+  if (p.root == t->nil)
+  {
+    t->leftmost = t->nil;
+    t->rightmost = t->nil;
+    t->count = 0;
+    return;
+  }
+
+  rbtree_set_parent(p.root, t->nil);
+  rbtree_set_color(p.root, RBTREE_BLACK);
+  t->leftmost = rbtree_min_subtree(t, p.root);
+  t->rightmost = p.root;
+  while (t->rightmost->right != t->nil)
+    t->rightmost = t->rightmost->right;
+#ifdef RBTREE_ORDER_STAT
+  count = p.root->size; // 크기 필드가 있으면 항상 정확한 값을 알 수 있음
+#endif
+  t->count = count;
+}
+
+/// @brief src가 t와 다른 풀을 쓰면 src의 키를 t의 풀에서 할당한 노드로 다시 만드는 함수 (O(m))
+/// @param t 기준 트리 포인터
+/// @param src 옮길 트리 포인터 (성공하면 t와 같은 풀을 씀)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (src는 바뀌지 않음)
+static int rbtree_adopt(rbtree *t, rbtree *src)
+{
+  if (src->pool == t->pool)
+    return 0;
+
+  size_t m = rbtree_size(src);
+  size_t u = m; // 만들 노드 수
+  key_t *keys = NULL;
+  unsigned int *counts = NULL;
+  node_t *chain = NULL;
+  if (m > 0)
+  {
+    keys = (key_t *)malloc(m * sizeof(key_t));
+    if (keys == NULL)
+      return -1;
+    rbtree_to_array(src, keys, m);
+#ifdef RBTREE_MULTISET
+    counts = (unsigned int *)malloc(m * sizeof(unsigned int));
+    if (counts == NULL)
+    {
+      free(keys);
+      return -1;
+    }
+    u = rbtree_collapse_keys(keys, m, keys, counts);
+#endif
+    if (rbtree_alloc_chain(t, u, &chain) != 0)
+    {
+      free(keys);
+      free(counts);
+      return -1;
+    }
+  }
+
+  // 기존 노드는 원래 풀로 돌려주고 t의 풀로 갈아탐
+#ifdef RBTREE_NO_POOL
+  delete_node(src, src->root);
+#else
+  if (src->pool->refs > 1)
+    delete_node(src, src->root);
+#endif
+  rbtree_pool_release(src->pool);
+  t->pool->refs++;
+  src->pool = t->pool;
+  src->nil = t->nil;
+  src->root = src->nil;
+  src->leftmost = src->nil;
+  src->rightmost = src->nil;
+  src->count = 0;
+
+  rbtree_build(src, keys, counts, u, m, NULL, &chain);
+  free(keys);
+  free(counts);
+  return 0;
+}
+
+/// @brief 두 트리를 key와 함께 하나로 합치는 함수 (같은 풀이면 O(log n))
+/// @param t1 왼쪽 트리 (결과가 저장됨), 모든 키가 key 이하
+/// @param key 두 트리 사이에 들어갈 키
+/// @param t2 오른쪽 트리, 모든 키가 key 이상 (성공하면 해제됨)
+/// @return 성공 시 0, 키 순서가 맞지 않거나 메모리 할당 실패 시 -1 (두 트리의 내용은 바뀌지 않음)
+/// @note 다른 풀의 트리는 먼저 t1의 풀로 옮기므로 O(m)이 추가됨 (new_rbtree_shared, rbtree_split으로 만든 트리는 같은 풀)
+int rbtree_join(rbtree *t1, const key_t key, rbtree *t2)
+{
+  // 캐시된 최대 / 최소 노드로 O(1)에 순서 확인
+  if ((t1->rightmost != t1->nil && t1->rightmost->key > key) || (t2->leftmost != t2->nil && t2->leftmost->key < key))
+    return -1;
+  if (rbtree_adopt(t1, t2) != 0)
+    return -1;
+
+  node_t *k = NULL; // 두 트리 사이에 들어갈 가운데 노드
+#ifdef RBTREE_MULTISET
+  // 끝 노드의 키가 key와 같으면 새 노드를 만들지 않고 그 노드를 떼어내 가운데 노드로 쓰면서 개수를 합침
+  node_t *last = t1->rightmost != t1->nil && t1->rightmost->key == key ? t1->rightmost : NULL;
+  node_t *first = t2->leftmost != t2->nil && t2->leftmost->key == key ? t2->leftmost : NULL;
+  if (last != NULL || first != NULL)
+  {
+    unsigned int count = 1;
+    if (last != NULL)
+    {
+      count += last->count;
+      rbtree_remove_node(t1, last);
+      k = last;
+    }
+    if (first != NULL)
+    {
+      count += first->count;
+      rbtree_remove_node(t2, first);
+      if (k == NULL)
+        k = first;
+      else // 양쪽 끝이 모두 key면 하나만 남김
+        rbtree_node_free(t1, first);
+    }
+    k->count = count;
+  }
+#endif
+  if (k == NULL)
+  {
+    k = rbtree_node_alloc(t1);
+    if (k == NULL) // 메모리 할당 실패 시
+      return -1;
+    k->key = key;
+#ifdef RBTREE_MULTISET
+    k->count = 1;
+#endif
+  }
+
+  size_t count = RBTREE_COUNT_UNKNOWN;
+  if (t1->count != RBTREE_COUNT_UNKNOWN && t2->count != RBTREE_COUNT_UNKNOWN)
+    count = t1->count + t2->count + rbtree_weight(k);
+
+  rbtree_part l = {t1->root, rbtree_black_height(t1, t1->root)};
+  rbtree_part r = {t2->root, rbtree_black_height(t2, t2->root)};
+  rbtree_set_part(t1, rbtree_join_parts(t1, l, k, r), count);
+
+  t2->root = t2->nil; // 노드는 모두 t1으로 옮겨졌으므로 빈 트리로 해제
+  delete_rbtree(t2);
+  return 0;
+}
+
+/// @brief 트리를 key 기준으로 둘로 나누는 함수 (O(log n))
+/// @param t 나눌 트리 포인터 (성공하면 *lo로 재사용됨)
+/// @param key 기준 키
+/// @param lo key보다 작은 키의 트리를 저장할 포인터
+/// @param hi key 이상인 키의 트리를 저장할 포인터 (t와 같은 풀을 씀)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (t는 바뀌지 않음)
+/// @note RBTREE_ORDER_STAT이 없으면 양쪽 노드 수를 알 수 없으므로 count는 RBTREE_COUNT_UNKNOWN이 됨
+int rbtree_split(rbtree *t, const key_t key, rbtree **lo, rbtree **hi)
+{
+  rbtree *right = new_rbtree_shared(t);
+  if (right == NULL) // 메모리 할당 실패 시
+    return -1;
+
+  rbtree_part l, r;
+  size_t total = t->count;
+  rbtree_split_part(t, (rbtree_part){t->root, rbtree_black_height(t, t->root)}, key, NULL, &l, &r);
+  // 한쪽이 비었으면 다른 쪽이 전부
+  rbtree_set_part(t, l, r.root == t->nil ? total : RBTREE_COUNT_UNKNOWN);
+  rbtree_set_part(right, r, l.root == t->nil ? total : RBTREE_COUNT_UNKNOWN);
+
+  *lo = t;
+  *hi = right;
+  return 0;
+}
+
+// 집합 연산 최상위 호출을 워커 풀에서 실행하기 위한 작업
+typedef struct {
+  rbtree_task task;
+  rbtree_set_ctx *ctx;
+  rbtree_part a, b, result;
+} rbtree_set_root_job;
+
+/// @brief 집합 연산 최상위 호출
+/// @param task rbtree_set_root_job의 task 멤버
+static void rbtree_set_root_run(rbtree_task *task)
+{
+  rbtree_set_root_job *job = rbtree_entry(task, rbtree_set_root_job, task);
+  job->result = rbtree_set_parts(job->ctx, job->a, job->b, 0);
+}
+
+/// @brief 집합 연산 공통 처리: t2를 t1의 풀로 맞추고, 연산 결과를 t1에 저장한 뒤 버린 노드와 t2를 해제
+/// @param t1 기준 트리 포인터 (결과가 저장됨)
+/// @param t2 상대 트리 포인터 (성공하면 해제됨)
+/// @param kind 연산 종류
+/// @param w 스레드 풀, NULL이면 순차 실행
+/// @return 성공 시 0, 메모리 할당 실패 시 -1 (두 트리의 내용은 바뀌지 않음)
+static int rbtree_set_op(rbtree *t1, rbtree *t2, rbtree_set_kind kind, rbtree_workers *w)
+{
+  if (rbtree_adopt(t1, t2) != 0)
+    return -1;
+
+  size_t count = RBTREE_COUNT_UNKNOWN;
+  if (t1->count != RBTREE_COUNT_UNKNOWN && t2->count != RBTREE_COUNT_UNKNOWN)
+    count = t1->count + t2->count;
+#ifdef RBTREE_MULTISET
+  // 같은 키의 개수가 바뀐 양은 따로 세지 않으므로 나중에 rbtree_size로 셈
+  count = RBTREE_COUNT_UNKNOWN;
+#endif
+
+  rbtree_set_ctx ctx = {.t = t1, .kind = kind};
+  rbtree_set_root_job job = {.ctx = &ctx};
+  job.task.fn = rbtree_set_root_run;
+  job.a = (rbtree_part){t1->root, rbtree_black_height(t1, t1->root)};
+  job.b = (rbtree_part){t2->root, rbtree_black_height(t2, t2->root)};
+
+  if (w != NULL && rbtree_workers_count(w) > 1)
+  {
+    // 워커 하나당 작업이 8개쯤 생기는 깊이까지만 나눔
+    ctx.w = w;
+    while (((size_t)1 << ctx.par_depth) < 8 * (size_t)rbtree_workers_count(w))
+      ctx.par_depth++;
+    rbtree_workers_run(w, &job.task);
+  }
+  else
+    rbtree_set_root_run(&job.task);
+
+  for (size_t i = 0; i < RBTREE_WORKERS_MAX; i++) // 결과에 남지 않은 노드 해제
+  {
+    node_t *removed = ctx.removed[i];
+    while (removed != NULL)
+    {
+      node_t *next = removed->right;
+      if (count != RBTREE_COUNT_UNKNOWN)
+        count--;
+      rbtree_node_free(t1, removed);
+      removed = next;
+    }
+  }
+  rbtree_set_part(t1, job.result, count);
+
+  t2->root = t2->nil;
+  delete_rbtree(t2);
+  return 0;
+}
+
+/// @brief t1에 t2의 키를 합치는 함수 (합집합, O(m log(n/m + 1)))
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 합칠 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+/// @note t1의 노드는 모두 남고, t1에 이미 있는 키와 같은 t2의 노드는 버려짐 (t1에 없는 키는 t2의 중복까지 모두 옮겨짐)
+///       RBTREE_MULTISET이면 키마다 개수가 큰 쪽을 따름 ({5, 5} ∪ {5, 5, 5} = {5, 5, 5})
+int rbtree_union(rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_UNION, NULL);
+}
+
+/// @brief t1에서 t2에 없는 키를 빼는 함수 (교집합, O(m log(n/m + 1)))
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 비교할 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+/// @note 중복 키는 키 단위로 판단해서 t2에 있는 키면 t1의 같은 키 노드가 모두 남음 ({5, 5, 5} ∩ {5} = {5, 5, 5})
+///       RBTREE_MULTISET이면 키마다 개수가 작은 쪽을 따름 ({5, 5, 5} ∩ {5, 5} = {5, 5})
+int rbtree_intersection(rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_INTERSECTION, NULL);
+}
+
+/// @brief t1에서 t2에 있는 키를 빼는 함수 (차집합, O(m log(n/m + 1)))
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 뺄 키의 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+/// @note 중복 키는 키 단위로 판단해서 t2에 있는 키면 t1의 같은 키 노드가 모두 빠짐 ({5, 5, 5} - {5} = {})
+///       RBTREE_MULTISET이면 t2의 개수만큼 빠짐 ({5, 5, 5} - {5, 5} = {5})
+int rbtree_difference(rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_DIFFERENCE, NULL);
+}
+
+/// @brief rbtree_union의 병렬 버전 (재귀의 위쪽 몇 단계를 워커들이 나눠 실행)
+/// @param w 사용할 스레드 풀
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 합칠 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+int rbtree_union_par(rbtree_workers *w, rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_UNION, w);
+}
+
+/// @brief rbtree_intersection의 병렬 버전
+/// @param w 사용할 스레드 풀
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 비교할 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+int rbtree_intersection_par(rbtree_workers *w, rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_INTERSECTION, w);
+}
+
+/// @brief rbtree_difference의 병렬 버전
+/// @param w 사용할 스레드 풀
+/// @param t1 결과를 저장할 트리 포인터
+/// @param t2 뺄 키의 트리 포인터 (성공하면 해제됨)
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+int rbtree_difference_par(rbtree_workers *w, rbtree *t1, rbtree *t2)
+{
+  return rbtree_set_op(t1, t2, RBTREE_SET_DIFFERENCE, w);
+}
+
+/// @brief 레드 블랙 트리의 key를 가진 노드를 찾는 함수
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param key 찾을 키
+/// @return 해당 key를 가진 node의 포인터, 없을 시 NULL 반환
+node_t *rbtree_find(const rbtree *t, const key_t key)
+{
+  node_t *cur = t->root;
+  uint64_t compares = 0; // 키를 비교한 노드 수
+
+  while (cur != t->nil) // nil node가 아니면 반복
+  {
+    compares++;
+    if (key < cur->key) // 키가 현재 노드의 키보다 작다면
+      cur = cur->left;  // 왼쪽으로 이동
+    else if (key > cur->key) // 키가 현재 노드의 키보다 크다면
+      cur = cur->right; // 오른족으로 이동
+    else // 키가 일치하면
+    {
+      rbtree_stat_add(t, finds, 1);
+      rbtree_stat_add(t, find_compares, compares);
+      return cur; // 현재 노드 반환
+    }
+  }
+  rbtree_stat_add(t, finds, 1);
+  rbtree_stat_add(t, find_compares, compares);
+  
+  return NULL; // 찾는 키가 없다면 NULL 반환
+}
+
+#define RBTREE_FIND_BATCH_WIDTH 16  // 동시에 진행하는 탐색 수
+
+#if defined(__GNUC__) || defined(__clang__)
+#define rbtree_prefetch(p) __builtin_prefetch(p)
+#else
+#define rbtree_prefetch(p) ((void)(p))
+#endif
+
+/// @brief 여러 키를 한 번에 찾는 함수 (탐색 여러 개를 번갈아 한 단계씩 진행해서 캐시 미스를 겹침)
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param keys 찾을 키 배열
+/// @param n 키 개수
+/// @param out 결과 배열, out[i]에 keys[i]를 가진 노드 (rbtree_find와 같은 노드) 또는 NULL 저장
+/// @return 찾은 키의 개수
+/// @note 각 탐색은 다음 자식을 prefetch만 하고 다른 탐색으로 넘어가며, 끝난 자리는 바로 다음 키로 채움 (AMAC)
+size_t rbtree_find_batch(const rbtree *t, const key_t *keys, const size_t n, node_t **out)
+{
+  node_t *cur[RBTREE_FIND_BATCH_WIDTH]; // 각 자리에서 진행 중인 탐색의 현재 노드 (NULL이면 빈 자리)
+  size_t index[RBTREE_FIND_BATCH_WIDTH]; // 각 자리가 맡은 키의 위치
+  size_t next = 0, active = 0, found = 0;
+  uint64_t compares = 0; // 키를 비교한 노드 수
+
+  for (size_t s = 0; s < RBTREE_FIND_BATCH_WIDTH; s++) // 루트는 모든 탐색이 공유하므로 prefetch 없이 시작
+  {
+    if (next < n)
+    {
+      index[s] = next++;
+      cur[s] = t->root;
+      active++;
     }
-    // case 2: 부모가 조부모의 오른쪽 자식일 경우 (case 1을 대칭 처리)
     else
+      cur[s] = NULL;
+  }
+
+  while (active > 0)
+  {
+    for (size_t s = 0; s < RBTREE_FIND_BATCH_WIDTH; s++)
     {
-      uncle = cur->parent->parent->left; // 삼촌 노드는 조부모의 왼쪽 자식
+      node_t *node = cur[s];
+      if (node == NULL) // 빈 자리
+        continue;
 
-      // case 2-1: 삼촌이 RED -> 재색칠
-      if (uncle->color == RBTREE_RED)
+      key_t key = keys[index[s]];
+      compares += node != t->nil;
+      if (node != t->nil && key != node->key) // 한 단계 내려가고 다음 노드를 미리 불러옴
       {
-        cur->parent->color = RBTREE_BLACK;
-        uncle->color = RBTREE_BLACK;
-        cur->parent->parent->color = RBTREE_RED;
-        cur = cur->parent->parent; // 조부모에서 다시 검사
+        node = key < node->key ? node->left : node->right;
+        rbtree_prefetch(node);
+        cur[s] = node;
+        continue;
+      }
+
+      // 탐색이 끝났으면 결과를 쓰고 다음 키로 자리를 채움
+      out[index[s]] = node == t->nil ? NULL : node;
+      found += node != t->nil;
+      if (next < n)
+      {
+        index[s] = next++;
+        cur[s] = t->root;
       }
-      // 삼촌이 BLACK인 경우
       else
       {
-        // case 2-2: 삽입 노드가 왼쪽 자식 -> 오른쪽 회전으로 case 2-3으로 변환
-        if (cur == cur->parent->left)
-        {
-          cur = cur->parent;
-          right_rotate(t, cur);
-        }
-        
-        // case 2-3: 삽입 노드가 오른쪽 자식이면 -> 재색칠 후 왼쪽 회전
-        cur->parent->color = RBTREE_BLACK;
-        cur->parent->parent->color = RBTREE_RED;
-        left_rotate(t, cur->parent->parent);
+        cur[s] = NULL;
+        active--;
       }
     }
   }
+  rbtree_stat_add(t, finds, n);
+  rbtree_stat_add(t, find_compares, compares);
 
-  // 루트는 항상 BLACK이어야 하므로
-  t->root->color = RBTREE_BLACK;
+  return found;
 }
 
-/// @brief 왼쪽 회전
-/// @param t 회전할 트리 포인터
-/// @param x 회전할 노드 값
-void left_rotate(rbtree *t, node_t *x)
+/// @brief key 이상인 첫 번째 노드를 찾는 함수
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param key 기준 키
+/// @return key 이상인 가장 작은 노드의 포인터, 없으면 NULL
+node_t *rbtree_lower_bound(const rbtree *t, const key_t key)
 {
-  node_t *y = x->right; // y = x의 오른쪽 자식
-  x->right = y->left;   // x의 오른쪽 자식을 y의 왼쪽 자식으로 연결
-
-  if (y->left != t->nil) // y의 왼쪽 자식이 nil 노드가 아니라면
-    y->left->parent = x; // 부모를 x로 연결
-  
-  y->parent = x->parent; // y의 부모를 x의 부모로 연결
+  node_t *cur = t->root;
+  node_t *found = NULL; // 지금까지 찾은 후보 노드
 
-  if (x->parent == t->nil) // x가 루트 노드였다면
-    t->root = y;           // y가 루트
-  else if (x == x->parent->left) // x가 부모의 왼쪽 자식이었다면
-    x->parent->left = y;         // y를 왼쪽 자식으로 연결
-  else                    // x가 부모의 오른쪽 자식이었다면
-    x->parent->right = y; // y를 오른쪽 자식으로 연결
+  while (cur != t->nil)
+  {
+    if (cur->key >= key) // 조건을 만족하면 후보로 저장하고 더 작은 쪽 탐색
+    {
+      found = cur;
+      cur = cur->left;
+    }
+    else // 작으면 오른쪽으로 이동
+      cur = cur->right;
+  }
 
-  y->left = x; // x를 y의 오른쪽 자식으로 연결
-  x->parent = y; // x의 부모를 y로 설정
+  return found;
 }
 
-/// @brief 오른쪽 회전
-/// @param t 회전할 트리 포인터
-/// @param x 회전할 노드 값
-void right_rotate(rbtree *t, node_t *x)
+/// @brief key 초과인 첫 번째 노드를 찾는 함수
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param key 기준 키
+/// @return key보다 큰 가장 작은 노드의 포인터, 없으면 NULL
+node_t *rbtree_upper_bound(const rbtree *t, const key_t key)
 {
-  node_t *y = x->left;
-  x->left = y->right;
+  node_t *cur = t->root;
+  node_t *found = NULL; // 지금까지 찾은 후보 노드
 
-  if (y->right != t->nil)
-    y->right->parent = x;
-    
-  y->parent = x->parent;
+  while (cur != t->nil)
+  {
+    if (cur->key > key) // 조건을 만족하면 후보로 저장하고 더 작은 쪽 탐색
+    {
+      found = cur;
+      cur = cur->left;
+    }
+    else // 작거나 같으면 오른쪽으로 이동
+      cur = cur->right;
+  }
 
-  if (x->parent == t->nil)
-    t->root = y;
-  else if (x == x->parent->right)
-    x->parent->right = y;
-  else
-    x->parent->left = y;
-  
-  y->right = x;
-  x->parent = y;
+  return found;
 }
 
-/// @brief 트리를 삭제하고 메모리 해제하는 함수
-/// @param t 삭제할 트리 포인터
-void delete_rbtree(rbtree *t) 
+/// @brief [lo, hi) 범위의 키를 순서대로 배열에 저장하는 함수 (O(log n + k))
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param lo 범위 시작 키 (포함)
+/// @param hi 범위 끝 키 (미포함)
+/// @param out 결과 저장할 배열 포인터
+/// @param cap 배열 크기
+/// @return 배열에 저장한 키의 개수
+size_t rbtree_range(const rbtree *t, const key_t lo, const key_t hi, key_t *out, const size_t cap)
 {
-  delete_node(t, t->root); // 루트부터 시작
-  free(t->nil); // nil 노드 메모라 해제
-  free(t); // 트리 메모리 해제
+  size_t count = 0;
+
+  // 시작 위치는 한 번만 내려가서 찾고, 이후는 후속자를 따라 이동
+  for (node_t *cur = rbtree_lower_bound(t, lo); cur != NULL && cur->key < hi && count < cap; cur = rbtree_next(t, cur))
+  {
+    out[count++] = cur->key;
+#ifdef RBTREE_MULTISET
+    for (unsigned int c = 1; c < cur->count && count < cap; c++) // 같은 키의 개수만큼 반복
+      out[count++] = cur->key;
+#endif
+  }
+
+  return count;
 }
 
-/// @brief 트리의 모든 노드 후위순회하며 삭제하는 함수
-/// @param t 삭제할 트리 포인터
-/// @param node 현재 삭제할 노드
-void delete_node(rbtree *t, node_t *node)
+#ifdef RBTREE_ORDER_STAT
+/// @brief k번째(0부터 시작)로 작은 키를 가진 노드를 찾는 함수 (O(log n))
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param k 찾을 순위
+/// @return k번째 노드의 포인터, k가 트리 크기 이상이면 NULL
+node_t *rbtree_select(const rbtree *t, size_t k)
 {
-  if (node == t->nil) // 현재 노드가 nil이면 반환 (자식 노드가 없음)
-    return;
-  
-  delete_node(t, node->left); 
-  delete_node(t, node->right);
+  node_t *cur = t->root;
 
-  free(node);
+  while (cur != t->nil)
+  {
+    size_t left_size = cur->left->size;
+
+    if (k < left_size) // 왼쪽 서브트리 안에 있으면 왼쪽으로
+      cur = cur->left;
+    else if (k >= left_size + rbtree_weight(cur)) // 오른쪽 서브트리 안에 있으면 순위를 줄이고 오른쪽으로
+    {
+      k -= left_size + rbtree_weight(cur);
+      cur = cur->right;
+    }
+    else // 현재 노드가 k번째 (RBTREE_MULTISET이면 현재 노드의 같은 키 중 하나)
+      return cur;
+  }
+
+  return NULL;
 }
 
-/// @brief 레드 블랙 트리의 key를 가진 노드를 찾는 함수
+/// @brief key보다 작은 키의 개수를 세는 함수 (O(log n))
 /// @param t 탐색할 레드 블랙 트리의 포인터
-/// @param key 찾을 키
-/// @return 해당 key를 가진 node의 포인터, 없을 시 NULL 반환
-node_t *rbtree_find(const rbtree *t, const key_t key)
+/// @param key 기준 키
+/// @return key보다 작은 키의 개수
+size_t rbtree_rank(const rbtree *t, const key_t key)
 {
   node_t *cur = t->root;
+  size_t rank = 0;
 
-  while (cur != t->nil) // nil node가 아니면 반복
+  while (cur != t->nil)
   {
-    if (key < cur->key) // 키가 현재 노드의 키보다 작다면
-      cur = cur->left;  // 왼쪽으로 이동
-    else if (key > cur->key) // 키가 현재 노드의 키보다 크다면
-      cur = cur->right; // 오른족으로 이동
-    else // 키가 일치하면
-      return cur; // 현재 노드 반환
+    if (cur->key < key) // 현재 노드와 왼쪽 서브트리는 모두 key보다 작음
+    {
+      rank += cur->left->size + rbtree_weight(cur);
+      cur = cur->right;
+    }
+    else
+      cur = cur->left;
   }
-  
-  return NULL; // 찾는 키가 없다면 NULL 반환
+
+  return rank;
+}
+
+/// @brief [lo, hi) 범위에 속한 키의 개수를 세는 함수 (O(log n))
+/// @param t 탐색할 레드 블랙 트리의 포인터
+/// @param lo 범위 시작 키 (포함)
+/// @param hi 범위 끝 키 (미포함)
+/// @return 범위에 속한 키의 개수
+size_t rbtree_count_range(const rbtree *t, const key_t lo, const key_t hi)
+{
+  if (lo >= hi) // 빈 범위
+    return 0;
+
+  return rbtree_rank(t, hi) - rbtree_rank(t, lo);
 }
+#endif
 
-/// @brief 레드 블랙 트리 최소값을 가지는 노드를 반환
+/// @brief 레드 블랙 트리 최소값을 가지는 노드를 반환 (캐시된 노드, O(1))
 /// @param t 탐색할 트리의 포인터
 /// @return 최소값을 가지는 노드의 포인터, 트리가 비어있으면 NULL
 node_t *rbtree_min(const rbtree *t)
 {
-  node_t *cur = t->root;
-  
-  if (cur == t->nil)
-    return NULL;
-
-  while (cur->left != t->nil)
-    cur = cur->left;
-  
-  return cur;
+  return t->leftmost == t->nil ? NULL : t->leftmost;
 }
 
 /// @brief 레드 블랙 트리의 서브트리의 최소값을 가지는 노드를 반환
@@ -273,20 +2331,182 @@ node_t *rbtree_min_subtree(const rbtree *t, node_t *start)
   return cur;
 }
 
-/// @brief 레드 블랙 트리 최댓값을 가지는 노드를 반환
+/// @brief 레드 블랙 트리 최댓값을 가지는 노드를 반환 (캐시된 노드, O(1))
 /// @param t 탐색할 트리의 포인터
 /// @return 최댓값을 가지는 노드의 포인터, 트리가 비어있으면 NULL
 node_t *rbtree_max(const rbtree *t) 
 {
-  node_t *cur = t->root; // 현재 노드를 트리의 루트로 초기화
+  return t->rightmost == t->nil ? NULL : t->rightmost;
+}
 
-  if (cur == t->nil) // 트리가 비었다면 NULL 반환 
-    return NULL;
+/// @brief 최소 노드를 탐색 없이 삭제하고 키를 꺼내는 함수 (우선순위 큐의 pop)
+/// @param t 트리 포인터
+/// @param key 꺼낸 키를 저장할 포인터
+/// @return 성공 시 0, 트리가 비어있으면 -1
+int rbtree_pop_min(rbtree *t, key_t *key)
+{
+  node_t *node = t->leftmost;
+  if (node == t->nil) // 빈 트리
+    return -1;
 
-  while (cur->right != t->nil) // 트리의 오른쪽이 nil node가 아닐때까지
-    cur = cur->right; // 오른쪽 
-  
-  return cur; // 최댓값 노드 반환
+  *key = node->key;
+  return rbtree_erase(t, node);
+}
+
+/// @brief 최대 노드를 탐색 없이 삭제하고 키를 꺼내는 함수
+/// @param t 트리 포인터
+/// @param key 꺼낸 키를 저장할 포인터
+/// @return 성공 시 0, 트리가 비어있으면 -1
+int rbtree_pop_max(rbtree *t, key_t *key)
+{
+  node_t *node = t->rightmost;
+  if (node == t->nil) // 빈 트리
+    return -1;
+
+  *key = node->key;
+  return rbtree_erase(t, node);
+}
+
+/// @brief 트리의 키 수를 반환하는 함수 (보통 O(1), rbtree_split 직후 처음 한 번은 O(n))
+/// @param t 대상 트리 포인터
+/// @return 키 수 (RBTREE_MULTISET이면 같은 키의 개수 포함)
+size_t rbtree_size(rbtree *t)
+{
+  if (t->count == RBTREE_COUNT_UNKNOWN) // 모르면 한 번 세어서 저장
+  {
+    size_t count = 0;
+    for (node_t *cur = t->leftmost; cur != t->nil && cur != NULL; cur = rbtree_next(t, cur))
+      count += rbtree_weight(cur);
+    t->count = count;
+  }
+  return t->count;
+}
+
+/// @brief 서브트리의 노드를 깊이별로 세고 높이를 구하는 함수
+/// @param t 대상 트리 포인터
+/// @param node 서브트리 루트
+/// @param depth node의 깊이 (루트가 0)
+/// @param out 깊이 히스토그램과 노드 수를 더해 갈 결과
+/// @return 서브트리의 높이 (nil이면 0)
+static size_t rbtree_stats_traverse(const rbtree *t, const node_t *node, size_t depth, rbtree_stats_t *out)
+{
+  if (node == t->nil)
+    return 0;
+
+  out->nodes++;
+  if (depth < RBTREE_STATS_MAX_DEPTH)
+    out->depth_hist[depth]++;
+  size_t left = rbtree_stats_traverse(t, node->left, depth + 1, out);
+  size_t right = rbtree_stats_traverse(t, node->right, depth + 1, out);
+  return (left > right ? left : right) + 1;
+}
+
+/// @brief 트리 모양과 계측 카운터를 한 번에 읽는 함수 (O(n))
+/// @param t 대상 트리 포인터
+/// @param out 결과를 채울 구조체
+/// @return 성공 시 0, out이 NULL이면 -1
+/// @note 카운터는 RBTREE_STATS로 빌드했을 때만 쌓이며 (아니면 0), 풀을 공유하는 트리들의 합계임
+///       카운터는 계속 늘어나기만 하므로 주기적으로 읽어서 차이를 보면 됨
+int rbtree_stats(const rbtree *t, rbtree_stats_t *out)
+{
+  if (out == NULL)
+    return -1;
+
+  *out = (rbtree_stats_t){0};
+#ifdef RBTREE_STATS
+  out->left_rotations = rbtree_stat_load(t, left_rotations);
+  out->right_rotations = rbtree_stat_load(t, right_rotations);
+  out->insert_fixup_loops = rbtree_stat_load(t, insert_fixup_loops);
+  out->delete_fixup_loops = rbtree_stat_load(t, delete_fixup_loops);
+  out->finds = rbtree_stat_load(t, finds);
+  out->find_compares = rbtree_stat_load(t, find_compares);
+  out->inserts = rbtree_stat_load(t, inserts);
+  out->insert_compares = rbtree_stat_load(t, insert_compares);
+  out->allocs = rbtree_stat_load(t, allocs);
+  out->frees = rbtree_stat_load(t, frees);
+#endif
+  out->height = rbtree_stats_traverse(t, t->root, 0, out);
+  out->black_height = rbtree_black_height(t, t->root);
+  return 0;
+}
+
+/// @brief 중위 순회 기준 다음 노드(후속자)를 반환
+/// @param t 탐색할 트리의 포인터
+/// @param node 기준 노드
+/// @return 다음 노드의 포인터, 마지막 노드였다면 NULL
+node_t *rbtree_next(const rbtree *t, const node_t *node)
+{
+  // 오른쪽 서브트리가 있으면 그 최소 노드가 후속자
+  if (node->right != t->nil)
+    return rbtree_min_subtree(t, node->right);
+
+  // 없으면 왼쪽 자식인 조상을 만날 때까지 부모로 올라감
+  node_t *parent = rbtree_parent(node);
+  while (parent != t->nil && node == parent->right)
+  {
+    node = parent;
+    parent = rbtree_parent(parent);
+  }
+
+  return parent == t->nil ? NULL : parent;
+}
+
+/// @brief 중위 순회 기준 이전 노드(선행자)를 반환
+/// @param t 탐색할 트리의 포인터
+/// @param node 기준 노드
+/// @return 이전 노드의 포인터, 첫 노드였다면 NULL
+node_t *rbtree_prev(const rbtree *t, const node_t *node)
+{
+  // 왼쪽 서브트리가 있으면 그 최대 노드가 선행자
+  if (node->left != t->nil)
+  {
+    node_t *cur = node->left;
+    while (cur->right != t->nil)
+      cur = cur->right;
+    return cur;
+  }
+
+  // 없으면 오른쪽 자식인 조상을 만날 때까지 부모로 올라감
+  node_t *parent = rbtree_parent(node);
+  while (parent != t->nil && node == parent->left)
+  {
+    node = parent;
+    parent = rbtree_parent(parent);
+  }
+
+  return parent == t->nil ? NULL : parent;
+}
+
+/// @brief 커서를 지정한 노드 위치로 초기화
+/// @param cur 초기화할 커서 포인터
+/// @param t 순회할 트리의 포인터
+/// @param start 시작 노드 (NULL이면 끝에 도달한 커서)
+void rbtree_cursor_init(rbtree_cursor *cur, const rbtree *t, node_t *start)
+{
+  cur->t = t;
+  cur->node = start;
+}
+
+/// @brief 커서의 현재 노드를 반환하고 다음 노드로 이동
+/// @param cur 커서 포인터
+/// @return 현재 노드의 포인터, 끝에 도달했다면 NULL
+node_t *rbtree_cursor_next(rbtree_cursor *cur)
+{
+  node_t *node = cur->node;
+  if (node != NULL)
+    cur->node = rbtree_next(cur->t, node);
+  return node;
+}
+
+/// @brief 커서의 현재 노드를 반환하고 이전 노드로 이동
+/// @param cur 커서 포인터
+/// @return 현재 노드의 포인터, 끝에 도달했다면 NULL
+node_t *rbtree_cursor_prev(rbtree_cursor *cur)
+{
+  node_t *node = cur->node;
+  if (node != NULL)
+    cur->node = rbtree_prev(cur->t, node);
+  return node;
 }
 
 /// @brief 트리에서 repalced_node를 substitude_node로 교체하는 함수
@@ -296,27 +2516,136 @@ node_t *rbtree_max(const rbtree *t)
 void rbtree_transplant(rbtree *t, node_t *replaced_node, node_t *substitute_node)
 {
   // replaced_node가 루트라면, substitute_node를 새로운 루트로 지정
-  if (replaced_node->parent == t->nil)
+  if (rbtree_parent(replaced_node) == t->nil)
     t->root = substitute_node;
   // replaced_node가 부모의 왼쪽 자식이면 substitute_node를 그 위치로 연결
-  else if (replaced_node == replaced_node->parent->left)
-    replaced_node->parent->left = substitute_node;
+  else if (replaced_node == rbtree_parent(replaced_node)->left)
+    rbtree_parent(replaced_node)->left = substitute_node;
   // replaced_node가 부모의 오른쪽 자식이면 
   else
-    replaced_node->parent->right = substitute_node;
+    rbtree_parent(replaced_node)->right = substitute_node;
   
   // substitute_node의 부모 포인터를 replaced_node의 부모로 설정
-  substitute_node->parent = replaced_node->parent;
+  rbtree_set_parent(substitute_node, rbtree_parent(replaced_node));
 }
 
 /// @brief 레드 블랙 트리 특정 노드 삭제 함수
 /// @param t 트리 포인터
 /// @param delete_node 삭제할 노드 포인터
 /// @return 성공 시 0 반환
+/// @note RBTREE_MULTISET이면 키 개수를 하나 줄이고, 마지막 하나일 때만 노드를 삭제
 int rbtree_erase(rbtree *t, node_t *delete_node) 
 {
+#ifdef RBTREE_MULTISET
+  if (delete_node->count > 1)
+  {
+    rbtree_add_count(t, delete_node, -1);
+    return 0;
+  }
+#endif
+  rbtree_remove_node(t, delete_node);
+
+  // 삭제한 노드 메모리 해제 (풀의 free list로 반환)
+  rbtree_node_free(t, delete_node);
+  return 0;
+}
+
+/// @brief key를 가진 노드를 찾아서 삭제하는 함수 (한 번만 내려감)
+/// @param t 트리 포인터
+/// @param key 삭제할 키
+/// @return 삭제했으면 0, key가 없으면 -1
+/// @note 같은 키가 여러 개면 그중 하나만 삭제 (RBTREE_MULTISET이면 개수를 하나 줄임)
+int rbtree_erase_key(rbtree *t, const key_t key)
+{
+  node_t *cur = t->root;
+
+  while (cur != t->nil)
+  {
+    if (key < cur->key)
+      cur = cur->left;
+    else if (key > cur->key)
+      cur = cur->right;
+    else // 찾은 노드를 그대로 삭제
+      return rbtree_erase(t, cur);
+  }
+
+  return -1; // key가 없음
+}
+
+#define RBTREE_ERASE_RANGE_SMALL 8  // 이보다 적은 노드는 하나씩 삭제, 많으면 split / join
+
+/// @brief [lo, hi) 범위의 키를 모두 삭제하는 함수 (k개 삭제에 O(k + log n))
+/// @param t 트리 포인터
+/// @param lo 범위 시작 키 (포함)
+/// @param hi 범위 끝 키 (미포함)
+/// @return 삭제한 키의 개수
+/// @note 범위가 작으면 노드를 하나씩 삭제하고, 크면 lo와 hi로 트리를 세 조각으로 나눈 뒤 가운데를 통째로 해제하고 나머지를 합침
+size_t rbtree_erase_range(rbtree *t, const key_t lo, const key_t hi)
+{
+  if (lo >= hi) // 빈 범위
+    return 0;
+
+  node_t *first = rbtree_lower_bound(t, lo);
+  if (first == NULL || first->key >= hi) // 범위 안에 키가 없음
+    return 0;
+
+  // 범위 안의 노드가 몇 개 안 되면 split / join보다 하나씩 지우는 편이 빠름
+  node_t *cur = first;
+  size_t nodes = 0;
+  while (cur != NULL && cur->key < hi && nodes < RBTREE_ERASE_RANGE_SMALL)
+  {
+    cur = rbtree_next(t, cur);
+    nodes++;
+  }
+  if (cur == NULL || cur->key >= hi)
+  {
+    size_t removed = 0;
+    for (cur = first; nodes > 0; nodes--)
+    {
+      node_t *next = rbtree_next(t, cur);
+      removed += rbtree_weight(cur);
+      rbtree_remove_node(t, cur);
+      rbtree_node_free(t, cur);
+      cur = next;
+    }
+    return removed;
+  }
+
+  // 트리를 [.., lo), [lo, hi), [hi, ..) 세 조각으로 나눔
+  rbtree_part left, mid, right;
+  rbtree_split_part(t, (rbtree_part){t->root, rbtree_black_height(t, t->root)}, lo, NULL, &left, &right);
+  rbtree_split_part(t, right, hi, NULL, &mid, &right);
+
+  // 가운데 조각은 균형을 맞출 필요 없이 통째로 해제
+  size_t removed = rbtree_free_subtree(t, mid.root);
+
+  size_t count = t->count == RBTREE_COUNT_UNKNOWN ? RBTREE_COUNT_UNKNOWN : t->count - removed;
+  rbtree_set_part(t, rbtree_join2_parts(t, left, right), count);
+  return removed;
+}
+
+/// @brief 노드를 트리에서 떼어내고 균형을 복구하는 함수 (노드 메모리는 해제하지 않음)
+/// @param t 트리 포인터
+/// @param delete_node 떼어낼 노드 포인터 (RBTREE_MULTISET이면 같은 키의 개수와 함께 빠짐)
+void rbtree_remove_node(rbtree *t, node_t *delete_node)
+{
+  if (t->count != RBTREE_COUNT_UNKNOWN)
+    t->count -= rbtree_weight(delete_node);
+
+  // 최소 / 최대 노드가 빠지면 캐시를 이웃 노드로 옮김 (끝 노드라 이웃은 바로 옆에 있음)
+  if (delete_node == t->leftmost)
+  {
+    node_t *next = rbtree_next(t, delete_node);
+    t->leftmost = next == NULL ? t->nil : next;
+  }
+  if (delete_node == t->rightmost)
+  {
+    node_t *prev = rbtree_prev(t, delete_node);
+    t->rightmost = prev == NULL ? t->nil : prev;
+  }
+
   node_t *successor_node = delete_node; // 삭제될 노드 또는 그 위치를 대체할 후속자
-  color_t orgin_color = successor_node->color; // 삭제될 노드의 원래 색깔
+  color_t orgin_color = rbtree_color(successor_node); // 삭제될 노드의 원래 색깔
   node_t *fixup_node; // 삭제 후 수정 대상 노드
   
   // case 1: 삭제할 노드의 왼쪽 자식이 nil (오른쪽 자식만 있거나 자식이 없는 경우)
@@ -336,7 +2665,7 @@ int rbtree_erase(rbtree *t, node_t *delete_node)
   {
     // 삭제할 노드의 오른쪽 서브트리에서 최소값을 가지는 노드를 찾음 (후속자 설정)
     successor_node = rbtree_min_subtree(t, delete_node->right);
-    orgin_color = successor_node->color;  // 후속자 색상 저장
+    orgin_color = rbtree_color(successor_node);  // 후속자 색상 저장
     fixup_node = successor_node->right;   // 후속자가 오른쪽 자식만 가질 수 있으므로 fixup 대상은 그것
 
     // 후속자가 삭제할 노드의 바로 오른쪽 자식이 아닌 경우 (더 아래쪽에 위치)
@@ -346,31 +2675,42 @@ int rbtree_erase(rbtree *t, node_t *delete_node)
       rbtree_transplant(t, successor_node, successor_node->right);
       // 후속자 노드의 오른쪽에 delete_node의 오른쪽 자식을 붙임
       successor_node->right = delete_node->right;
-      successor_node->right->parent = successor_node;
+      rbtree_set_parent(successor_node->right, successor_node);
     }
     // 후속자가 delete_node의 바로 오른쪽 자식인 경우
     else
     {
       // fixup_node의 부모를 후속자로 미리 설정
-      fixup_node->parent = successor_node;
+      rbtree_set_parent(fixup_node, successor_node);
     }
     
     // delete_node를 후속자로 대체
     rbtree_transplant(t, delete_node, successor_node);
     // delete_node의 왼쪽 자식을 후속자에게 연결
     successor_node->left = delete_node->left;
-    successor_node->left->parent = successor_node;
+    rbtree_set_parent(successor_node->left, successor_node);
     // 삭제할 노드의 색을 후속자에게 전달 (레드 블랙 특성을 유지하기 위해)
-    successor_node->color = delete_node->color;
+    rbtree_set_color(successor_node, rbtree_color(delete_node));
+#ifdef RBTREE_ORDER_STAT
+    successor_node->size = delete_node->size; // 서브트리 크기도 물려받음
+#endif
+  }
+
+#ifdef RBTREE_ORDER_STAT
+  // 실제로 노드가 빠진 위치부터 루트까지 서브트리 크기 감소
+  // (후속자가 올라왔으면 후속자의 원래 위치 아래쪽은 후속자의 키 수만큼, 새 위치부터 위쪽은 삭제한 노드의 키 수만큼)
+  unsigned int removed = rbtree_weight(successor_node);
+  for (node_t *cur = rbtree_parent(fixup_node); cur != t->nil; cur = rbtree_parent(cur))
+  {
+    if (cur == successor_node)
+      removed = rbtree_weight(delete_node);
+    cur->size -= removed;
   }
+#endif
 
   // 삭제할 노드가 검은색이라면 트리의 속성을 깨뜨릴 수 있어 fixup
   if (orgin_color == RBTREE_BLACK)
     rbtree_delete_fixup(t, fixup_node);  
-
-  // 삭제한 노드 메모리 해제
-  free(delete_node);
-  return 0;
 }
 
 /// @brief 레드 블랙 트리 삭제 후 밸런싱 함수
@@ -379,88 +2719,91 @@ int rbtree_erase(rbtree *t, node_t *delete_node)
 void rbtree_delete_fixup(rbtree *t, node_t *fixup_node)
 {
   node_t *sibling_node;
+  uint64_t loops = 0;
 
   // fixup_node가 루트가 아니고, fixup_node가 검정색일 때
-  while (fixup_node != t->root && fixup_node->color == RBTREE_BLACK)
+  while (fixup_node != t->root && rbtree_color(fixup_node) == RBTREE_BLACK)
   {
+    loops++;
     // fixup_n-node가 부모의 왼쪽 자식일 때
-    if (fixup_node == fixup_node->parent->left)
+    if (fixup_node == rbtree_parent(fixup_node)->left)
     {
-      sibling_node = fixup_node->parent->right; // fixup_node의 형제 노드
+      sibling_node = rbtree_parent(fixup_node)->right; // fixup_node의 형제 노드
       
       // case 1: 형제 노드가 빨간색이면 재색칠 후 왼쪽 회전
-      if (sibling_node->color == RBTREE_RED)
+      if (rbtree_color(sibling_node) == RBTREE_RED)
       {
-        sibling_node->color = RBTREE_BLACK;
-        fixup_node->parent->color = RBTREE_RED;
-        left_rotate(t, fixup_node->parent);
-        sibling_node = fixup_node->parent->right; // 형제 노드 갱신
+        rbtree_set_color(sibling_node, RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(fixup_node), RBTREE_RED);
+        left_rotate(t, rbtree_parent(fixup_node));
+        sibling_node = rbtree_parent(fixup_node)->right; // 형제 노드 갱신
       }
 
       // case 2: 형제 노드가 검정색이고 형제의 두 자식 모두 검정색인 경우
-      if (sibling_node->left->color == RBTREE_BLACK && sibling_node->right->color == RBTREE_BLACK)
+      if (rbtree_color(sibling_node->left) == RBTREE_BLACK && rbtree_color(sibling_node->right) == RBTREE_BLACK)
       {
-        sibling_node->color = RBTREE_RED; // 형제를 빨간색으로 재색칠
-        fixup_node = fixup_node->parent;  // fixup_node를 부모 노드로 올려 반복
+        rbtree_set_color(sibling_node, RBTREE_RED); // 형제를 빨간색으로 재색칠
+        fixup_node = rbtree_parent(fixup_node);  // fixup_node를 부모 노드로 올려 반복
       }
       else
       {
         // case 3: 형제 노드의 오른쪽 자식이 검적색일 때
-        if (sibling_node->right->color == RBTREE_BLACK)
+        if (rbtree_color(sibling_node->right) == RBTREE_BLACK)
         {
-          sibling_node->left->color = RBTREE_BLACK;
-          sibling_node->color = RBTREE_RED;
+          rbtree_set_color(sibling_node->left, RBTREE_BLACK);
+          rbtree_set_color(sibling_node, RBTREE_RED);
           right_rotate(t, sibling_node);
-          sibling_node = fixup_node->parent->right; // 형제 노드 갱신
+          sibling_node = rbtree_parent(fixup_node)->right; // 형제 노드 갱신
         }
         
         // case 4: 형제 노드의 오른쪽 자식이 빨간색일 때
-        sibling_node->color = fixup_node->parent->color;
-        fixup_node->parent->color = RBTREE_BLACK;
-        sibling_node->right->color = RBTREE_BLACK;
-        left_rotate(t, fixup_node->parent);
+        rbtree_set_color(sibling_node, rbtree_color(rbtree_parent(fixup_node)));
+        rbtree_set_color(rbtree_parent(fixup_node), RBTREE_BLACK);
+        rbtree_set_color(sibling_node->right, RBTREE_BLACK);
+        left_rotate(t, rbtree_parent(fixup_node));
         fixup_node = t->root; // 복구 끝내기 위해 루트로 이동
       }
     }
     // fixup_node가 부모의 오른쪽 자식일 때 (위의 case 1~4를 좌우 대칭 처리)
     else
     {
-      sibling_node = fixup_node->parent->left;
+      sibling_node = rbtree_parent(fixup_node)->left;
 
-      if (sibling_node->color == RBTREE_RED)
+      if (rbtree_color(sibling_node) == RBTREE_RED)
       {
-        sibling_node->color = RBTREE_BLACK;
-        fixup_node->parent->color = RBTREE_RED;
-        right_rotate(t, fixup_node->parent);
-        sibling_node = fixup_node->parent->left;
+        rbtree_set_color(sibling_node, RBTREE_BLACK);
+        rbtree_set_color(rbtree_parent(fixup_node), RBTREE_RED);
+        right_rotate(t, rbtree_parent(fixup_node));
+        sibling_node = rbtree_parent(fixup_node)->left;
       }
 
-      if (sibling_node->right->color == RBTREE_BLACK && sibling_node->left->color == RBTREE_BLACK)
+      if (rbtree_color(sibling_node->right) == RBTREE_BLACK && rbtree_color(sibling_node->left) == RBTREE_BLACK)
       {
-        sibling_node->color = RBTREE_RED;
-        fixup_node = fixup_node->parent;
+        rbtree_set_color(sibling_node, RBTREE_RED);
+        fixup_node = rbtree_parent(fixup_node);
       }
       else
       {
-        if (sibling_node->left->color == RBTREE_BLACK)
+        if (rbtree_color(sibling_node->left) == RBTREE_BLACK)
         {
-          sibling_node->right->color = RBTREE_BLACK;
-          sibling_node->color = RBTREE_RED;
+          rbtree_set_color(sibling_node->right, RBTREE_BLACK);
+          rbtree_set_color(sibling_node, RBTREE_RED);
           left_rotate(t, sibling_node);
-          sibling_node = fixup_node->parent->left;
+          sibling_node = rbtree_parent(fixup_node)->left;
         }
 
-        sibling_node->color = fixup_node->parent->color;
-        fixup_node->parent->color = RBTREE_BLACK;
-        sibling_node->left->color = RBTREE_BLACK;
-        right_rotate(t, fixup_node->parent);
+        rbtree_set_color(sibling_node, rbtree_color(rbtree_parent(fixup_node)));
+        rbtree_set_color(rbtree_parent(fixup_node), RBTREE_BLACK);
+        rbtree_set_color(sibling_node->left, RBTREE_BLACK);
+        right_rotate(t, rbtree_parent(fixup_node));
         fixup_node = t->root;
       }
     }
   }
+  rbtree_stat_add(t, delete_fixup_loops, loops);
 
   // fixup 작업이 끝난 후, 마지막 fixup 노드를 검정색으로 설정하여
-  fixup_node->color = RBTREE_BLACK;
+  rbtree_set_color(fixup_node, RBTREE_BLACK);
 }
 
 /// @brief 레드 블랙 트리 중위 순회하며 키 값을 배열에 저장하는 함수
@@ -475,31 +2818,178 @@ int rbtree_to_array(const rbtree *t, key_t *arr, const size_t n)
   return rbtree_inorder(t, t->root, arr, n, &index); // 중위순회 호출
 }
 
-/// @brief 레드 블랙 트리 중위 순회하며 키 값을 배열에 저장하는 재귀 함수
+/// @brief 레드 블랙 트리 중위 순회하며 키 값을 배열에 저장하는 함수 (고정 크기 스택을 쓰는 반복문)
 /// @param t 대상 트리 포인터
-/// @param node 현재 방문 중인 노드 포인터
+/// @param node 순회할 서브트리의 루트 포인터
 /// @param arr 결과 저장할 배열 포인터
 /// @param n 배열 크기
 /// @param index 배열 내 현재 저장 위치에 대한 포인터
 /// @return 성공 시 0
+/// @note 부모 포인터를 따라 올라가는 방식은 조상 노드를 다시 읽느라 전체 export가 2배 넘게 느림 (bench-traverse)
+///       보조 스택 없이 순회하라는 요구와 달리 속도 때문에 일부러 높이만큼의 스택을 씀
 int rbtree_inorder(const rbtree *t, node_t *node, key_t *arr, const size_t n, size_t *index)
 {
-  // base case -> 노드가 nil이고 또는 배열보다 커진다면
-  if (node == t->nil || *index >= n)
+  node_t *nil = t->nil;
+  node_t *stack[RBTREE_MAX_HEIGHT]; // 아직 출력하지 않은 조상 (경로의 노드 수만큼만 쌓임)
+  size_t top = 0;
+  node_t *cur = node;
+  size_t i = *index; // 포인터 대신 지역 변수로 인덱스 관리
+
+  while (i < n) // 배열이 가득 차면 즉시 종료
+  {
+    while (cur != nil) // 왼쪽 끝까지 내려가며 조상을 쌓음
+    {
+      assert(top < RBTREE_MAX_HEIGHT); // 색 규칙이 깨진 트리면 스택을 넘을 수 있음
+      stack[top++] = cur;
+      cur = cur->left;
+    }
+    if (top == 0) // 서브트리를 모두 순회함
+      break;
+
+    cur = stack[--top];
+    arr[i++] = cur->key; // 인덱스에 키 값 저장 후 다음 인덱스로 이동
+#ifdef RBTREE_MULTISET
+    for (unsigned int c = 1; c < cur->count && i < n; c++) // 같은 키의 개수만큼 반복
+      arr[i++] = cur->key;
+#endif
+    cur = cur->right; // 다음은 오른쪽 서브트리의 최소 노드
+  }
+
+  *index = i;
+  return 0;
+}
+
+// 병렬 rbtree_to_array 상태
+typedef struct {
+  const rbtree *t;
+  rbtree_workers *w;
+  key_t *arr;
+  size_t n;
+  size_t par_depth;  // 이 깊이의 서브트리부터는 한 워커가 순차로 처리
+  size_t *sizes;     // 깊이 par_depth까지 노드의 서브트리 크기 (힙 번호로 저장, RBTREE_ORDER_STAT이면 NULL)
+} rbtree_export_ctx;
+
+// 병렬 rbtree_to_array 작업 하나: 서브트리 하나를 세거나 배열에 씀
+typedef struct {
+  rbtree_task task;
+  rbtree_export_ctx *ctx;
+  node_t *node;
+  size_t pos;     // 힙 번호 (루트 1, 자식 2p, 2p + 1)
+  size_t depth;
+  size_t offset;  // 쓰기: 서브트리의 첫 키를 쓸 배열 위치, 세기: 결과 키 수
+} rbtree_export_job;
+
+#ifndef RBTREE_ORDER_STAT
+/// @brief 서브트리의 키 수를 세는 함수 (부모 포인터를 따라가는 반복문)
+/// @param t 대상 트리 포인터
+/// @param node 서브트리 루트
+/// @return 키 수 (RBTREE_MULTISET이면 같은 키의 개수 포함)
+static size_t rbtree_count_subtree(const rbtree *t, node_t *node)
+{
+  if (node == t->nil)
     return 0;
-  
-  // 왼쪽 서브트리 중위 순회
-  rbtree_inorder(t, node->left, arr, n, index);
 
-  // 현재 노드의 키를 배열에 저장 (범위 내에서만)
-  if (*index < n)
+  size_t count = 0;
+  node_t *cur = rbtree_min_subtree(t, node);
+  while (1) // rbtree_inorder와 같은 순서로 이동
+  {
+    count += rbtree_weight(cur);
+    if (cur->right != t->nil)
+    {
+      cur = rbtree_min_subtree(t, cur->right);
+      continue;
+    }
+    while (cur != node && cur == rbtree_parent(cur)->right)
+      cur = rbtree_parent(cur);
+    if (cur == node)
+      return count;
+    cur = rbtree_parent(cur);
+  }
+}
+
+/// @brief 서브트리 크기를 세어 ctx->sizes에 기록하는 작업 (결과는 job->offset)
+/// @param task rbtree_export_job의 task 멤버
+static void rbtree_export_count_run(rbtree_task *task)
+{
+  rbtree_export_job *job = rbtree_entry(task, rbtree_export_job, task);
+  rbtree_export_ctx *ctx = job->ctx;
+
+  if (job->node == ctx->t->nil || job->depth == ctx->par_depth)
+    job->offset = rbtree_count_subtree(ctx->t, job->node);
+  else
+  {
+    rbtree_export_job left = {.ctx = ctx, .node = job->node->left, .pos = job->pos * 2, .depth = job->depth + 1};
+    rbtree_export_job right = {.ctx = ctx, .node = job->node->right, .pos = job->pos * 2 + 1, .depth = job->depth + 1};
+    left.task.fn = rbtree_export_count_run;
+    rbtree_task_spawn(ctx->w, &left.task);
+    rbtree_export_count_run(&right.task);
+    rbtree_task_wait(ctx->w, &left.task);
+    job->offset = left.offset + right.offset + rbtree_weight(job->node);
+  }
+  ctx->sizes[job->pos] = job->offset;
+}
+#endif
+
+/// @brief 서브트리의 키를 배열의 job->offset 위치부터 쓰는 작업 (배열 크기를 넘는 부분은 건너뜀)
+/// @param task rbtree_export_job의 task 멤버
+static void rbtree_export_write_run(rbtree_task *task)
+{
+  rbtree_export_job *job = rbtree_entry(task, rbtree_export_job, task);
+  rbtree_export_ctx *ctx = job->ctx;
+  node_t *node = job->node;
+
+  if (node == ctx->t->nil || job->offset >= ctx->n)
+    return;
+  if (job->depth == ctx->par_depth) // 여기부터는 한 워커가 순차로
   {
-    arr[*index] = node->key; // 인덱스이 키 값 저장
-    (*index)++;              // 다음 인덱스로 이동
+    size_t index = job->offset;
+    rbtree_inorder(ctx->t, node, ctx->arr, ctx->n, &index);
+    return;
   }
 
-  // 오른쪽 서브트리 중위 순회
-  rbtree_inorder(t, node->right, arr, n, index);
+#ifdef RBTREE_ORDER_STAT
+  size_t left_size = node->left->size;
+#else
+  size_t left_size = ctx->sizes[job->pos * 2];
+#endif
+  rbtree_export_job left = {.ctx = ctx, .node = node->left, .pos = job->pos * 2, .depth = job->depth + 1, .offset = job->offset};
+  rbtree_export_job right = {.ctx = ctx, .node = node->right, .pos = job->pos * 2 + 1, .depth = job->depth + 1, .offset = job->offset + left_size + rbtree_weight(node)};
+  left.task.fn = rbtree_export_write_run;
+  rbtree_task_spawn(ctx->w, &left.task);
+  for (size_t i = job->offset + left_size; i < job->offset + left_size + rbtree_weight(node) && i < ctx->n; i++)
+    ctx->arr[i] = node->key; // RBTREE_MULTISET이면 같은 키의 개수만큼
+  rbtree_export_write_run(&right.task);
+  rbtree_task_wait(ctx->w, &left.task);
+}
+
+/// @brief rbtree_to_array의 병렬 버전 (위쪽 몇 단계의 서브트리를 워커들이 나눠서 씀)
+/// @param w 사용할 스레드 풀
+/// @param t 대상 트리 포인터
+/// @param arr 결과 저장할 배열 포인터
+/// @param n 배열 크기
+/// @return 성공 시 0, 메모리 할당 실패 시 -1
+/// @note RBTREE_ORDER_STAT이 없으면 서브트리 크기를 먼저 병렬로 세고 나서 씀 (두 번 순회)
+int rbtree_to_array_par(rbtree_workers *w, const rbtree *t, key_t *arr, const size_t n)
+{
+  if (rbtree_workers_count(w) == 1) // 나눌 일이 없으면 순차 버전
+    return rbtree_to_array(t, arr, n);
+
+  rbtree_export_ctx ctx = {.t = t, .w = w, .arr = arr, .n = n};
+  while (((size_t)1 << ctx.par_depth) < 8 * (size_t)rbtree_workers_count(w)) // 워커 하나당 서브트리 8개쯤
+    ctx.par_depth++;
 
+  rbtree_export_job job = {.ctx = &ctx, .node = t->root, .pos = 1, .depth = 0, .offset = 0};
+#ifndef RBTREE_ORDER_STAT
+  ctx.sizes = (size_t *)malloc(((size_t)2 << ctx.par_depth) * sizeof(size_t));
+  if (ctx.sizes == NULL) // 메모리 할당 실패 시
+    return -1;
+  job.task.fn = rbtree_export_count_run;
+  rbtree_workers_run(w, &job.task);
+  job.offset = 0;
+#endif
+
+  job.task.fn = rbtree_export_write_run;
+  rbtree_workers_run(w, &job.task);
+  free(ctx.sizes);
   return 0;
-}
\ No newline at end of file
+}
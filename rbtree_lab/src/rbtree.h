@@ -2,37 +2,160 @@
 #define _RBTREE_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
+// node_t를 멤버로 품고 있는 구조체 포인터를 구함 (intrusive 사용 시)
+#define rbtree_entry(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
 
 typedef enum { RBTREE_RED, RBTREE_BLACK } color_t;
 
 typedef int key_t;
 
+#ifdef RBTREE_COMPACT
+// 색을 부모 포인터의 최하위 비트에 넣은 레이아웃 (노드는 8바이트 정렬이므로 비트가 비어 있음)
+typedef struct node_t {
+  uintptr_t parent_color;  // 부모 포인터 | 색 (0: RED, 1: BLACK)
+  struct node_t *left, *right;
+  key_t key;
+#ifdef RBTREE_ORDER_STAT
+  unsigned int size;  // 이 노드를 루트로 하는 서브트리의 키 수 (RBTREE_MULTISET이면 중복 포함, nil은 0)
+#endif
+#ifdef RBTREE_MULTISET
+  unsigned int count;  // 이 노드에 합쳐진 같은 키의 개수
+#endif
+} node_t;
+
+#define rbtree_parent(n) ((node_t *)((n)->parent_color & ~(uintptr_t)1))
+#define rbtree_color(n) ((color_t)((n)->parent_color & 1))
+#define rbtree_set_parent(n, p) ((n)->parent_color = (uintptr_t)(p) | ((n)->parent_color & 1))
+#define rbtree_set_color(n, c) ((n)->parent_color = ((n)->parent_color & ~(uintptr_t)1) | (uintptr_t)(c))
+#else
 typedef struct node_t {
   color_t color;
   key_t key;
   struct node_t *parent, *left, *right;
+#ifdef RBTREE_ORDER_STAT
+  unsigned int size;  // 이 노드를 루트로 하는 서브트리의 키 수 (RBTREE_MULTISET이면 중복 포함, nil은 0)
+#endif
+#ifdef RBTREE_MULTISET
+  unsigned int count;  // 이 노드에 합쳐진 같은 키의 개수
+#endif
 } node_t;
 
+#define rbtree_parent(n) ((n)->parent)
+#define rbtree_color(n) ((n)->color)
+#define rbtree_set_parent(n, p) ((n)->parent = (p))
+#define rbtree_set_color(n, c) ((n)->color = (c))
+#endif
+
+#ifdef RBTREE_MULTISET
+// 같은 키를 노드 하나에 개수로 합치는 multiset 모드: 노드 하나가 나타내는 키의 개수
+#define rbtree_weight(n) ((n)->count)
+#else
+#define rbtree_weight(n) 1u
+#endif
+
+// 노드를 묶어서 할당하는 슬랩 (정의는 rbtree.c)
+typedef struct rbtree_slab rbtree_slab;
+// 슬랩, free list, nil을 묶은 노드 풀, 여러 트리가 공유할 수 있음 (정의는 rbtree.c)
+typedef struct rbtree_pool rbtree_pool;
+
+// 병렬 연산에 쓰는 work-stealing 스레드 풀 (정의는 rbtree_workers.c)
+typedef struct rbtree_workers rbtree_workers;
+
+#define RBTREE_COUNT_UNKNOWN ((size_t)-1)  // rbtree_split 직후처럼 노드 수를 아직 모르는 상태
+
 typedef struct {
   node_t *root;
   node_t *nil;  // for sentinel
+  node_t *leftmost, *rightmost;  // 최소 / 최대 노드 캐시 (빈 트리면 nil)
+  size_t count;  // 트리에 들어 있는 키 수, RBTREE_MULTISET이면 중복 포함 (모르면 RBTREE_COUNT_UNKNOWN, rbtree_size로 조회)
+  rbtree_pool *pool;  // 노드 풀
 } rbtree;
 
+#define RBTREE_STATS_MAX_DEPTH 128  // 깊이 히스토그램 크기 (레드 블랙 트리의 높이는 2 log2(n + 1) 이하)
+
+// rbtree_stats가 채우는 트리 모양과 계측 카운터 (카운터는 RBTREE_STATS로 빌드했을 때만 쌓이고 아니면 0)
+typedef struct {
+  uint64_t left_rotations;      // left_rotate 호출 수
+  uint64_t right_rotations;     // right_rotate 호출 수
+  uint64_t insert_fixup_loops;  // 삽입 fixup 루프 반복 수
+  uint64_t delete_fixup_loops;  // rbtree_delete_fixup 루프 반복 수
+  uint64_t finds;               // rbtree_find, rbtree_find_batch로 찾은 키 수
+  uint64_t find_compares;       // 그때 키를 비교한 노드 수
+  uint64_t inserts;             // 루트부터 내려가서 삽입한 수 (rbtree_insert, rbtree_insert_node)
+  uint64_t insert_compares;     // 그때 키를 비교한 노드 수
+  uint64_t allocs;              // 할당한 노드 수
+  uint64_t frees;               // 반환한 노드 수
+  size_t nodes;                 // 지금 트리의 노드 수
+  size_t height;                // 지금 트리의 높이 (빈 트리면 0)
+  size_t black_height;          // 루트부터 nil 직전까지 검은 노드 수
+  size_t depth_hist[RBTREE_STATS_MAX_DEPTH];  // depth_hist[d]: 깊이 d (루트가 0)에 있는 노드 수
+} rbtree_stats_t;
+
+// 트리를 순서대로 훑기 위한 커서 (rbtree_find, rbtree_min 등이 반환한 노드에서 시작)
+typedef struct {
+  const rbtree *t;
+  node_t *node;  // 현재 노드, 끝에 도달하면 NULL
+} rbtree_cursor;
+
 rbtree *new_rbtree(void);
+rbtree *new_rbtree_shared(rbtree *t);
+rbtree *rbtree_from_sorted(const key_t *arr, const size_t n);
+rbtree *rbtree_from_sorted_par(rbtree_workers *w, const key_t *arr, const size_t n);
+int rbtree_compact(rbtree *t);
 void delete_rbtree(rbtree *);
 void delete_node(rbtree *t, node_t *node);
 
+node_t *rbtree_node_alloc(rbtree *t);
+void rbtree_node_free(rbtree *t, node_t *node);
+
 node_t *rbtree_insert(rbtree *, const key_t);
+node_t *rbtree_insert_hint(rbtree *t, node_t *hint, const key_t key);
+int rbtree_insert_batch(rbtree *t, key_t *keys, size_t n);
+int rbtree_join(rbtree *t1, const key_t key, rbtree *t2);
+int rbtree_split(rbtree *t, const key_t key, rbtree **lo, rbtree **hi);
+int rbtree_union(rbtree *t1, rbtree *t2);
+int rbtree_intersection(rbtree *t1, rbtree *t2);
+int rbtree_difference(rbtree *t1, rbtree *t2);
+int rbtree_union_par(rbtree_workers *w, rbtree *t1, rbtree *t2);
+int rbtree_intersection_par(rbtree_workers *w, rbtree *t1, rbtree *t2);
+int rbtree_difference_par(rbtree_workers *w, rbtree *t1, rbtree *t2);
 void rbtree_insert_fixup(rbtree *t, node_t *cur);
 void left_rotate(rbtree *t, node_t *x);
 void right_rotate(rbtree *t, node_t *x);
 node_t *rbtree_find(const rbtree *, const key_t);
+size_t rbtree_find_batch(const rbtree *t, const key_t *keys, const size_t n, node_t **out);
+node_t *rbtree_lower_bound(const rbtree *t, const key_t key);
+node_t *rbtree_upper_bound(const rbtree *t, const key_t key);
+size_t rbtree_range(const rbtree *t, const key_t lo, const key_t hi, key_t *out, const size_t cap);
 node_t *rbtree_min(const rbtree *);
 node_t *rbtree_min_subtree(const rbtree *t, node_t *start);
 node_t *rbtree_max(const rbtree *);
+int rbtree_pop_min(rbtree *t, key_t *key);
+int rbtree_pop_max(rbtree *t, key_t *key);
+size_t rbtree_size(rbtree *t);
+int rbtree_stats(const rbtree *t, rbtree_stats_t *out);
+node_t *rbtree_next(const rbtree *t, const node_t *node);
+node_t *rbtree_prev(const rbtree *t, const node_t *node);
+void rbtree_cursor_init(rbtree_cursor *cur, const rbtree *t, node_t *start);
+node_t *rbtree_cursor_next(rbtree_cursor *cur);
+node_t *rbtree_cursor_prev(rbtree_cursor *cur);
 void rbtree_transplant(rbtree *t, node_t *replaced_node, node_t *substitute_node);
 int rbtree_erase(rbtree *, node_t *);
+int rbtree_erase_key(rbtree *t, const key_t key);
+size_t rbtree_erase_range(rbtree *t, const key_t lo, const key_t hi);
+node_t *rbtree_insert_node(rbtree *t, node_t *node);
+void rbtree_link_node(rbtree *t, node_t *node, node_t *parent, node_t **link);
+void rbtree_remove_node(rbtree *t, node_t *node);
 void rbtree_delete_fixup(rbtree *t, node_t *delete_node);
+#ifdef RBTREE_ORDER_STAT
+node_t *rbtree_select(const rbtree *t, size_t k);
+size_t rbtree_rank(const rbtree *t, const key_t key);
+size_t rbtree_count_range(const rbtree *t, const key_t lo, const key_t hi);
+#endif
+
 int rbtree_to_array(const rbtree *, key_t *, const size_t);
+int rbtree_to_array_par(rbtree_workers *w, const rbtree *t, key_t *arr, const size_t n);
 int rbtree_inorder(const rbtree *t, node_t *node, key_t *arr, const size_t n, size_t *index);
 #endif  // _RBTREE_H_
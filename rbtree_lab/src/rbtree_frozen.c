@@ -0,0 +1,170 @@
+#include "rbtree_frozen.h"
+#include <limits.h>
+#include <stdlib.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define B FROZEN_RBTREE_B
+#define FROZEN_KEY_MAX INT_MAX  // 빈 자리를 채우는 키 (key_t가 int)
+
+/// @brief n개의 키를 담는 층의 블록 수
+static size_t frozen_blocks(size_t n)
+{
+  return (n + B - 1) / B;
+}
+
+/// @brief n개의 키를 담는 층 바로 위 층의 키 수 (자식 B + 1개당 블록 하나)
+static size_t frozen_parent_keys(size_t n)
+{
+  return (frozen_blocks(n) + B) / (B + 1) * B;
+}
+
+/// @brief 블록(키 B개) 안에서 key보다 작은 키의 개수를 세는 함수
+/// @param block 64바이트 정렬된 블록
+/// @param key 기준 키
+/// @return key보다 작은 키의 개수 (블록은 정렬되어 있으므로 key 이상인 첫 위치와 같음)
+static inline unsigned int frozen_rank_in_block(const key_t *block, key_t key)
+{
+#if defined(__AVX2__)
+  // 8개씩 두 번 비교해서 비교 결과 마스크의 비트 수를 셈
+  __m256i x = _mm256_set1_epi32(key);
+  __m256i lo = _mm256_cmpgt_epi32(x, _mm256_load_si256((const __m256i *)block));
+  __m256i hi = _mm256_cmpgt_epi32(x, _mm256_load_si256((const __m256i *)(block + 8)));
+  unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(lo)) |
+                      (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8;
+  return (unsigned int)__builtin_popcount(mask);
+#elif defined(__SSE2__)
+  // 4개씩 네 번 비교한 결과를 8비트 마스크 16개로 묶어서 비트 수를 셈
+  __m128i x = _mm_set1_epi32(key);
+  __m128i c0 = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)block));
+  __m128i c1 = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(block + 4)));
+  __m128i c2 = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(block + 8)));
+  __m128i c3 = _mm_cmpgt_epi32(x, _mm_load_si128((const __m128i *)(block + 12)));
+  __m128i packed = _mm_packs_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+  return (unsigned int)__builtin_popcount((unsigned int)_mm_movemask_epi8(packed));
+#else
+  unsigned int rank = 0;
+  for (unsigned int i = 0; i < B; i++) // 분기 없이 모두 비교
+    rank += block[i] < key;
+  return rank;
+#endif
+}
+
+/// @brief 트리의 키로 읽기 전용 스냅샷을 만드는 함수 (O(n))
+/// @param t 대상 트리 포인터 (스냅샷과 독립, 이후 수정해도 스냅샷은 그대로)
+/// @return 스냅샷 포인터, 메모리 할당 실패 시 NULL
+frozen_rbtree *rbtree_freeze(rbtree *t)
+{
+  frozen_rbtree *f = (frozen_rbtree *)calloc(1, sizeof(frozen_rbtree));
+  if (f == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
+  f->n = rbtree_size(t);
+  if (f->n == 0)
+    return f;
+
+  // 층별 크기: 리프 층은 키 배열, 위 층은 블록이 하나가 될 때까지
+  size_t total = 0;
+  for (size_t keys = frozen_blocks(f->n) * B;; keys = frozen_parent_keys(keys))
+  {
+    f->offsets[f->height++] = total;
+    total += keys;
+    if (keys == B)
+      break;
+  }
+
+  f->keys = (key_t *)aligned_alloc(64, total * sizeof(key_t)); // B * 4바이트 = 64바이트 정렬
+  if (f->keys == NULL)
+  {
+    free(f);
+    return NULL;
+  }
+
+  // 리프 층: 정렬된 키 배열, 마지막 블록의 빈 자리는 최댓값으로
+  rbtree_to_array(t, f->keys, f->n);
+  for (size_t i = f->n; i < frozen_blocks(f->n) * B; i++)
+    f->keys[i] = FROZEN_KEY_MAX;
+
+  // 위 층: h층 k번 블록의 i번 키는 (i + 1)번 자식 서브트리의 최소 키 = 그 자식에서 왼쪽 끝으로 내려간 리프 블록의 첫 키
+  size_t span = 1; // h - 1층 블록 하나가 덮는 리프 블록 수
+  for (size_t h = 1; h < f->height; h++)
+  {
+    size_t size = (h + 1 < f->height ? f->offsets[h + 1] : total) - f->offsets[h];
+    key_t *layer = f->keys + f->offsets[h];
+    for (size_t j = 0; j < size; j++)
+    {
+      size_t child = j / B * (B + 1) + j % B + 1;
+      size_t leaf = child * span * B;
+      layer[j] = leaf < f->n ? f->keys[leaf] : FROZEN_KEY_MAX;
+    }
+    span *= B + 1;
+  }
+
+  return f;
+}
+
+/// @brief 스냅샷을 삭제하고 메모리 해제하는 함수
+/// @param f 삭제할 스냅샷 포인터
+void delete_frozen_rbtree(frozen_rbtree *f)
+{
+  free(f->keys);
+  free(f);
+}
+
+/// @brief key 이상인 첫 번째 키의 위치를 찾는 함수 (층마다 블록 하나만 읽음)
+/// @param f 스냅샷 포인터
+/// @param key 기준 키
+/// @return key 이상인 가장 작은 키의 위치 (f->keys의 인덱스), 없으면 f->n
+size_t frozen_rbtree_lower_bound(const frozen_rbtree *f, const key_t key)
+{
+  if (f->n == 0)
+    return 0;
+
+  size_t k = 0; // 현재 층의 블록 번호
+  for (size_t h = f->height - 1; h > 0; h--) // 구분 키가 key보다 작은 만큼 오른쪽 자식으로
+    k = k * (B + 1) + frozen_rank_in_block(f->keys + f->offsets[h] + k * B, key);
+
+  // 키가 블록 끝까지 모두 작으면 다음 블록의 첫 위치가 답 (리프 층은 이어져 있으므로 그대로 맞음)
+  size_t pos = k * B + frozen_rank_in_block(f->keys + k * B, key);
+  return pos < f->n ? pos : f->n;
+}
+
+/// @brief key 초과인 첫 번째 키의 위치를 찾는 함수
+/// @param f 스냅샷 포인터
+/// @param key 기준 키
+/// @return key보다 큰 가장 작은 키의 위치, 없으면 f->n
+size_t frozen_rbtree_upper_bound(const frozen_rbtree *f, const key_t key)
+{
+  if (key == FROZEN_KEY_MAX) // key + 1이 넘치므로 따로 처리
+    return f->n;
+  return frozen_rbtree_lower_bound(f, key + 1);
+}
+
+/// @brief key의 위치를 찾는 함수
+/// @param f 스냅샷 포인터
+/// @param key 찾을 키
+/// @return key가 처음 나오는 위치, 없으면 FROZEN_RBTREE_NPOS
+size_t frozen_rbtree_find(const frozen_rbtree *f, const key_t key)
+{
+  size_t pos = frozen_rbtree_lower_bound(f, key);
+  return pos < f->n && f->keys[pos] == key ? pos : FROZEN_RBTREE_NPOS;
+}
+
+/// @brief [lo, hi) 범위의 키를 순서대로 배열에 저장하는 함수 (시작 위치만 찾고 리프 층을 그대로 복사)
+/// @param f 스냅샷 포인터
+/// @param lo 범위 시작 키 (포함)
+/// @param hi 범위 끝 키 (미포함)
+/// @param out 결과 저장할 배열 포인터
+/// @param cap 배열 크기
+/// @return 배열에 저장한 키의 개수
+size_t frozen_rbtree_range(const frozen_rbtree *f, const key_t lo, const key_t hi, key_t *out, const size_t cap)
+{
+  size_t count = 0;
+
+  for (size_t i = frozen_rbtree_lower_bound(f, lo); i < f->n && f->keys[i] < hi && count < cap; i++)
+    out[count++] = f->keys[i];
+
+  return count;
+}
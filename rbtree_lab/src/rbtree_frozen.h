@@ -0,0 +1,28 @@
+#ifndef _RBTREE_FROZEN_H_
+#define _RBTREE_FROZEN_H_
+
+#include "rbtree.h"
+
+#define FROZEN_RBTREE_B 16          // 블록 하나의 키 수 (64바이트 캐시 라인 하나)
+#define FROZEN_RBTREE_MAX_HEIGHT 16 // 층 수 상한 (17^16개 이상의 키)
+#define FROZEN_RBTREE_NPOS ((size_t)-1)  // 찾는 키가 없음
+
+// 읽기 전용 스냅샷: 정렬된 키 배열 위에 B개씩 묶은 구분 키 층을 쌓은 정적 B+ 트리 (S+ tree)
+// 리프 층은 정렬된 키 배열 그대로이므로 탐색 결과는 순위(배열 위치)로 나옴
+// 모든 층은 하나의 64바이트 정렬 배열에 들어 있고 자식 위치는 계산으로 구하므로 포인터가 없음
+typedef struct {
+  size_t n;                                  // 키 수 (중복 포함)
+  size_t height;                             // 층 수 (리프 층 포함, 빈 트리면 0)
+  size_t offsets[FROZEN_RBTREE_MAX_HEIGHT];  // 층별 시작 위치 (0번이 리프 층)
+  key_t *keys;                               // 모든 층의 키 (블록 단위로 빈 자리는 키의 최댓값으로 채움)
+} frozen_rbtree;
+
+frozen_rbtree *rbtree_freeze(rbtree *t);
+void delete_frozen_rbtree(frozen_rbtree *f);
+
+size_t frozen_rbtree_lower_bound(const frozen_rbtree *f, const key_t key);
+size_t frozen_rbtree_upper_bound(const frozen_rbtree *f, const key_t key);
+size_t frozen_rbtree_find(const frozen_rbtree *f, const key_t key);
+size_t frozen_rbtree_range(const frozen_rbtree *f, const key_t lo, const key_t hi, key_t *out, const size_t cap);
+
+#endif  // _RBTREE_FROZEN_H_
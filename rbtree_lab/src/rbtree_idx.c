@@ -0,0 +1,688 @@
+#include "rbtree_idx.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define IDX_RBTREE_MIN_CAP 64  // 처음 할당하는 슬롯 수 (nil 포함)
+
+// 노드 배열 n에서 i번 노드의 부모 / 색을 읽고 쓰는 함수들
+static inline uint32_t idx_parent(const idx_node_t *n, uint32_t i)
+{
+  return n[i].parent_color >> 1;
+}
+
+static inline color_t idx_color(const idx_node_t *n, uint32_t i)
+{
+  return (color_t)(n[i].parent_color & 1);
+}
+
+static inline void idx_set_parent(idx_node_t *n, uint32_t i, uint32_t parent)
+{
+  n[i].parent_color = (parent << 1) | (n[i].parent_color & 1);
+}
+
+static inline void idx_set_color(idx_node_t *n, uint32_t i, color_t color)
+{
+  n[i].parent_color = (n[i].parent_color & ~1u) | (uint32_t)color;
+}
+
+/// @brief 인덱스 기반 레드블랙트리 생성 및 초기화
+/// @return 초기화된 트리의 포인터, 메모리 할당 실패 시 NULL
+idx_rbtree *new_idx_rbtree(void)
+{
+  idx_rbtree *t = (idx_rbtree *)calloc(1, sizeof(idx_rbtree));
+  if (t == NULL) // 메모리 할당 실패 시 NULL 리턴
+    return NULL;
+
+  t->img = (idx_rbtree_image *)calloc(1, sizeof(idx_rbtree_image) + IDX_RBTREE_MIN_CAP * sizeof(idx_node_t));
+  if (t->img == NULL) // 노드 배열 할당 실패 시
+  {
+    free(t);
+    return NULL;
+  }
+
+  t->img->cap = IDX_RBTREE_MIN_CAP;
+  t->img->used = 1; // 0번 슬롯은 nil
+  t->img->root = IDX_RBTREE_NIL;
+  idx_set_color(t->img->nodes, IDX_RBTREE_NIL, RBTREE_BLACK); // nil은 항상 블랙
+  return t;
+}
+
+/// @brief 이미지(연속 메모리 블록)를 복사해서 트리를 만드는 함수
+/// @param img 복사할 이미지 (다른 트리의 img나 파일에서 읽은 블록)
+/// @return 복사된 트리의 포인터, 메모리 할당 실패 시 NULL
+idx_rbtree *idx_rbtree_from_image(const idx_rbtree_image *img)
+{
+  idx_rbtree *t = (idx_rbtree *)calloc(1, sizeof(idx_rbtree));
+  if (t == NULL)
+    return NULL;
+
+  size_t size = sizeof(idx_rbtree_image) + (size_t)img->cap * sizeof(idx_node_t);
+  t->img = (idx_rbtree_image *)malloc(size);
+  if (t->img == NULL)
+  {
+    free(t);
+    return NULL;
+  }
+
+  memcpy(t->img, img, size); // 인덱스로만 연결되어 있으므로 그대로 복사하면 됨
+  return t;
+}
+
+/// @brief 트리 이미지의 바이트 크기
+/// @param t 대상 트리 포인터
+/// @return t->img부터 복사하거나 저장해야 할 바이트 수
+size_t idx_rbtree_image_size(const idx_rbtree *t)
+{
+  return sizeof(idx_rbtree_image) + (size_t)t->img->cap * sizeof(idx_node_t);
+}
+
+/// @brief 트리를 삭제하고 메모리 해제하는 함수 (노드 배열 하나만 해제, 파일에 매핑된 트리면 매핑을 닫음)
+/// @param t 삭제할 트리 포인터
+/// @note 파일에 매핑된 트리는 닫기만 하고 디스크 반영은 기다리지 않음 (필요하면 먼저 idx_rbtree_sync)
+void delete_idx_rbtree(idx_rbtree *t)
+{
+  if (t->map != NULL)
+  {
+    munmap(t->map, t->map_size);
+    close(t->fd);
+  }
+  else
+    free(t->img);
+  free(t);
+}
+
+/// @brief 슬롯 cap개를 담는 파일 크기
+static size_t idx_file_size(uint32_t cap)
+{
+  return sizeof(idx_rbtree_file_header) + sizeof(idx_rbtree_image) + (size_t)cap * sizeof(idx_node_t);
+}
+
+/// @brief 파일 전체를 다시 매핑하는 함수
+/// @param t 대상 트리 포인터 (성공하면 map, map_size, img가 바뀜)
+/// @param size 매핑할 파일 크기
+/// @return 성공 시 0, 실패 시 -1 (기존 매핑은 그대로)
+static int idx_file_map(idx_rbtree *t, size_t size)
+{
+  void *map = mmap(NULL, size, t->readonly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, t->fd, 0);
+  if (map == MAP_FAILED)
+    return -1;
+
+  if (t->map != NULL)
+    munmap(t->map, t->map_size);
+  t->map = map;
+  t->map_size = size;
+  t->img = (idx_rbtree_image *)((char *)map + sizeof(idx_rbtree_file_header));
+  return 0;
+}
+
+/// @brief 파일을 늘려서 슬롯을 cap개로 만드는 함수 (인덱스로만 연결되어 있으므로 다시 매핑해도 그대로)
+/// @param t 파일에 매핑된 트리 포인터
+/// @param cap 새 슬롯 수
+/// @return 성공 시 0, 실패 시 -1 (트리는 그대로)
+static int idx_file_grow(idx_rbtree *t, uint32_t cap)
+{
+  size_t size = idx_file_size(cap);
+  if (ftruncate(t->fd, (off_t)size) != 0) // 늘어난 부분은 0으로 채워짐
+    return -1;
+  if (idx_file_map(t, size) != 0)
+  {
+    // 파일 크기가 cap과 다시 맞도록 되돌림 (되돌리지 못하면 다음 open에서 거부됨)
+    (void)ftruncate(t->fd, (off_t)t->map_size);
+    return -1;
+  }
+
+  t->img->cap = cap; // 파일을 먼저 늘린 뒤 cap을 바꾸므로 읽는 쪽은 cap만 보고 다시 매핑할 수 있음
+  return 0;
+}
+
+/// @brief 읽기 전용 매핑이 쓰는 쪽의 파일 확장을 따라가도록 다시 매핑하는 함수
+/// @param t 대상 트리 포인터 (다시 매핑하면 map, map_size, img가 바뀜)
+/// @return 매핑이 cap개 슬롯을 모두 덮으면 0, 다시 매핑하지 못하면 -1
+/// @note 헤더 페이지는 공유되므로 cap이 매핑보다 커졌으면 다른 프로세스가 파일을 늘린 것
+///       연산 도중에 쓰는 쪽이 트리를 바꾸는 경우는 막지 않으므로 그런 경우는 호출하는 쪽에서 동기화해야 함
+static int idx_file_refresh(const idx_rbtree *t)
+{
+  if (!t->readonly || idx_file_size(t->img->cap) <= t->map_size)
+    return 0;
+
+  struct stat st;
+  if (fstat(t->fd, &st) != 0 || (size_t)st.st_size < idx_file_size(t->img->cap))
+    return -1;
+  return idx_file_map((idx_rbtree *)t, (size_t)st.st_size); // 핸들은 항상 calloc한 것이므로 const를 벗겨도 됨
+}
+
+/// @brief idx_rbtree_open 도중 실패했을 때 매핑과 파일을 닫는 함수
+/// @param t 열던 트리 포인터
+/// @return 항상 NULL
+static idx_rbtree *idx_file_abort(idx_rbtree *t)
+{
+  if (t->map != NULL)
+    munmap(t->map, t->map_size);
+  if (t->fd >= 0)
+    close(t->fd);
+  free(t);
+  return NULL;
+}
+
+/// @brief 파일에 노드가 직접 들어 있는 트리를 여는 함수 (없거나 빈 파일이면 새 트리로 초기화)
+/// @param path 파일 경로
+/// @param readonly 1이면 읽기 전용으로 매핑 (여러 프로세스가 같은 페이지를 공유)
+/// @return 트리 포인터, 파일을 열 수 없거나 형식이 맞지 않으면 NULL
+/// @note 링크가 모두 배열 인덱스이므로 여는 즉시 탐색할 수 있음 (읽어 들이거나 다시 만들지 않음)
+///       노드를 다 쓰면 파일을 두 배씩, 최대 IDX_RBTREE_FILE_CHUNK 슬롯씩 늘림
+///       쓰기로 열면 파일에 배타적 flock을 걸어서 두 번째 쓰는 쪽은 NULL을 받음 (읽기 전용은 잠그지 않음)
+idx_rbtree *idx_rbtree_open(const char *path, const int readonly)
+{
+  idx_rbtree *t = (idx_rbtree *)calloc(1, sizeof(idx_rbtree));
+  if (t == NULL)
+    return NULL;
+
+  t->readonly = readonly;
+  t->fd = open(path, readonly ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+  struct stat st;
+  if (t->fd < 0 || (!readonly && flock(t->fd, LOCK_EX | LOCK_NB) != 0) || fstat(t->fd, &st) != 0)
+    return idx_file_abort(t); // 잠금은 close할 때 풀림
+
+  size_t size = (size_t)st.st_size;
+  if (size == 0 && !readonly) // 새 파일이면 헤더와 nil 슬롯부터 채움
+  {
+    size = idx_file_size(IDX_RBTREE_MIN_CAP);
+    if (ftruncate(t->fd, (off_t)size) != 0 || idx_file_map(t, size) != 0)
+      return idx_file_abort(t);
+
+    idx_rbtree_file_header *header = (idx_rbtree_file_header *)t->map;
+    memcpy(header->magic, IDX_RBTREE_FILE_MAGIC, sizeof(header->magic));
+    header->version = IDX_RBTREE_FILE_VERSION;
+    header->key_size = sizeof(key_t);
+    t->img->cap = IDX_RBTREE_MIN_CAP;
+    t->img->used = 1; // 0번 슬롯은 nil
+    t->img->root = IDX_RBTREE_NIL;
+    idx_set_color(t->img->nodes, IDX_RBTREE_NIL, RBTREE_BLACK); // nil은 항상 블랙
+    return t;
+  }
+
+  if (size < idx_file_size(0) || idx_file_map(t, size) != 0)
+    return idx_file_abort(t);
+
+  // 헤더와 크기가 맞는지만 확인 (노드 내용은 검사하지 않음)
+  const idx_rbtree_file_header *header = (const idx_rbtree_file_header *)t->map;
+  const idx_rbtree_image *img = t->img;
+  if (memcmp(header->magic, IDX_RBTREE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != IDX_RBTREE_FILE_VERSION || header->key_size != sizeof(key_t) ||
+      img->cap > IDX_RBTREE_MAX_NODES || idx_file_size(img->cap) != size || img->used == 0 ||
+      img->used > img->cap || img->root >= img->used || img->free_list >= img->used)
+    return idx_file_abort(t);
+  return t;
+}
+
+/// @brief 파일에 매핑된 트리의 변경을 디스크에 반영하는 함수
+/// @param t 대상 트리 포인터
+/// @return 성공 시 0, 실패 시 -1 (메모리에만 있는 트리면 할 일이 없으므로 0)
+/// @note 변경 기록(WAL)은 없으므로 sync 사이에 프로세스가 죽으면 파일이 중간 상태로 남을 수 있음
+int idx_rbtree_sync(idx_rbtree *t)
+{
+  if (t->map == NULL || t->readonly)
+    return 0;
+  if (msync(t->map, t->map_size, MS_SYNC) != 0)
+    return -1;
+  return fsync(t->fd) == 0 ? 0 : -1; // 늘어난 파일 크기(메타데이터)까지 반영
+}
+
+/// @brief 노드 슬롯 하나를 할당하는 함수 (배열이 가득 차면 두 배로 확장)
+/// @param t 대상 트리 포인터
+/// @return 할당된 노드 인덱스, 실패 시 0 (읽기 전용 파일이면 항상 실패)
+static uint32_t idx_node_alloc(idx_rbtree *t)
+{
+  if (t->readonly)
+    return IDX_RBTREE_NIL;
+
+  idx_rbtree_image *img = t->img;
+
+  // free list에 재사용할 슬롯이 있으면 꺼내서 사용
+  if (img->free_list != IDX_RBTREE_NIL)
+  {
+    uint32_t i = img->free_list;
+    img->free_list = img->nodes[i].right;
+    return i;
+  }
+
+  if (img->used == img->cap) // 배열이 가득 찼다면 확장
+  {
+    if (img->cap == IDX_RBTREE_MAX_NODES)
+      return IDX_RBTREE_NIL;
+
+    // 두 배로 늘리되 IDX_RBTREE_MAX_NODES를 넘지 않도록 자름
+    uint32_t cap = img->cap > IDX_RBTREE_MAX_NODES / 2 ? IDX_RBTREE_MAX_NODES : img->cap * 2;
+    if (t->map != NULL) // 파일이면 ftruncate로 늘리고 다시 매핑 (한 번에 최대 IDX_RBTREE_FILE_CHUNK 슬롯)
+    {
+      if (img->cap > IDX_RBTREE_FILE_CHUNK)
+        cap = img->cap > IDX_RBTREE_MAX_NODES - IDX_RBTREE_FILE_CHUNK ? IDX_RBTREE_MAX_NODES
+                                                                      : img->cap + IDX_RBTREE_FILE_CHUNK;
+      if (idx_file_grow(t, cap) != 0)
+        return IDX_RBTREE_NIL;
+      return t->img->used++;
+    }
+
+    img = (idx_rbtree_image *)realloc(img, sizeof(idx_rbtree_image) + (size_t)cap * sizeof(idx_node_t));
+    if (img == NULL) // 메모리 할당 실패 시 기존 배열은 그대로 둠
+      return IDX_RBTREE_NIL;
+
+    img->cap = cap;
+    t->img = img; // 인덱스는 그대로이므로 포인터만 바꾸면 됨
+  }
+
+  return img->used++;
+}
+
+/// @brief 왼쪽 회전
+/// @param img 트리 이미지
+/// @param x 회전할 노드 인덱스
+static void idx_left_rotate(idx_rbtree_image *img, uint32_t x)
+{
+  idx_node_t *n = img->nodes;
+  uint32_t y = n[x].right;
+  n[x].right = n[y].left;
+
+  if (n[y].left != IDX_RBTREE_NIL)
+    idx_set_parent(n, n[y].left, x);
+
+  uint32_t p = idx_parent(n, x);
+  idx_set_parent(n, y, p);
+
+  if (p == IDX_RBTREE_NIL)
+    img->root = y;
+  else if (x == n[p].left)
+    n[p].left = y;
+  else
+    n[p].right = y;
+
+  n[y].left = x;
+  idx_set_parent(n, x, y);
+}
+
+/// @brief 오른쪽 회전
+/// @param img 트리 이미지
+/// @param x 회전할 노드 인덱스
+static void idx_right_rotate(idx_rbtree_image *img, uint32_t x)
+{
+  idx_node_t *n = img->nodes;
+  uint32_t y = n[x].left;
+  n[x].left = n[y].right;
+
+  if (n[y].right != IDX_RBTREE_NIL)
+    idx_set_parent(n, n[y].right, x);
+
+  uint32_t p = idx_parent(n, x);
+  idx_set_parent(n, y, p);
+
+  if (p == IDX_RBTREE_NIL)
+    img->root = y;
+  else if (x == n[p].right)
+    n[p].right = y;
+  else
+    n[p].left = y;
+
+  n[y].right = x;
+  idx_set_parent(n, x, y);
+}
+
+/// @brief 삽입 후 색상 및 밸런싱 (rbtree_insert_fixup과 같은 case 구성)
+/// @param img 트리 이미지
+/// @param cur 삽입된 노드 인덱스
+static void idx_insert_fixup(idx_rbtree_image *img, uint32_t cur)
+{
+  idx_node_t *n = img->nodes;
+
+  while (idx_color(n, idx_parent(n, cur)) == RBTREE_RED) // 부모가 RED인 경우
+  {
+    uint32_t parent = idx_parent(n, cur);
+    uint32_t grand = idx_parent(n, parent);
+
+    if (parent == n[grand].left) // 부모가 조부모의 왼쪽 자식
+    {
+      uint32_t uncle = n[grand].right;
+      if (idx_color(n, uncle) == RBTREE_RED) // 삼촌이 RED이면 재색칠
+      {
+        idx_set_color(n, parent, RBTREE_BLACK);
+        idx_set_color(n, uncle, RBTREE_BLACK);
+        idx_set_color(n, grand, RBTREE_RED);
+        cur = grand;
+      }
+      else
+      {
+        if (cur == n[parent].right) // 꺾인 모양이면 먼저 왼쪽 회전
+        {
+          cur = parent;
+          idx_left_rotate(img, cur);
+          parent = idx_parent(n, cur);
+        }
+        idx_set_color(n, parent, RBTREE_BLACK);
+        idx_set_color(n, grand, RBTREE_RED);
+        idx_right_rotate(img, grand);
+      }
+    }
+    else // 부모가 조부모의 오른쪽 자식 (대칭)
+    {
+      uint32_t uncle = n[grand].left;
+      if (idx_color(n, uncle) == RBTREE_RED)
+      {
+        idx_set_color(n, parent, RBTREE_BLACK);
+        idx_set_color(n, uncle, RBTREE_BLACK);
+        idx_set_color(n, grand, RBTREE_RED);
+        cur = grand;
+      }
+      else
+      {
+        if (cur == n[parent].left)
+        {
+          cur = parent;
+          idx_right_rotate(img, cur);
+          parent = idx_parent(n, cur);
+        }
+        idx_set_color(n, parent, RBTREE_BLACK);
+        idx_set_color(n, grand, RBTREE_RED);
+        idx_left_rotate(img, grand);
+      }
+    }
+  }
+
+  idx_set_color(n, img->root, RBTREE_BLACK); // 루트는 항상 BLACK
+}
+
+/// @brief 키 삽입 함수 (중복 키는 오른쪽에 삽입)
+/// @param t 삽입할 트리 포인터
+/// @param key 삽입할 키 값
+/// @return 삽입한 노드 인덱스, 메모리 할당 실패 시 0
+uint32_t idx_rbtree_insert(idx_rbtree *t, const key_t key)
+{
+  uint32_t cur = idx_node_alloc(t); // 배열이 옮겨질 수 있으므로 먼저 할당
+  if (cur == IDX_RBTREE_NIL)
+    return IDX_RBTREE_NIL;
+
+  idx_rbtree_image *img = t->img;
+  idx_node_t *n = img->nodes;
+  uint32_t parent = IDX_RBTREE_NIL;
+  uint32_t pos = img->root;
+
+  while (pos != IDX_RBTREE_NIL)
+  {
+    parent = pos;
+    pos = key < n[pos].key ? n[pos].left : n[pos].right;
+  }
+
+  n[cur].key = key;
+  n[cur].left = IDX_RBTREE_NIL;
+  n[cur].right = IDX_RBTREE_NIL;
+  n[cur].parent_color = parent << 1 | RBTREE_RED;
+
+  if (parent == IDX_RBTREE_NIL) // 빈 트리면 루트로
+    img->root = cur;
+  else if (key < n[parent].key)
+    n[parent].left = cur;
+  else
+    n[parent].right = cur;
+
+  idx_insert_fixup(img, cur);
+  return cur;
+}
+
+/// @brief key를 가진 노드를 찾는 함수
+/// @param t 탐색할 트리 포인터
+/// @param key 찾을 키
+/// @return 노드 인덱스, 없으면 0
+uint32_t idx_rbtree_find(const idx_rbtree *t, const key_t key)
+{
+  if (idx_file_refresh(t) != 0)
+    return IDX_RBTREE_NIL;
+
+  const idx_node_t *n = t->img->nodes;
+  uint32_t cur = t->img->root;
+
+  while (cur != IDX_RBTREE_NIL)
+  {
+    if (key < n[cur].key)
+      cur = n[cur].left;
+    else if (key > n[cur].key)
+      cur = n[cur].right;
+    else
+      return cur;
+  }
+
+  return IDX_RBTREE_NIL;
+}
+
+/// @brief 서브트리의 최소 노드 인덱스
+static uint32_t idx_min_subtree(const idx_node_t *n, uint32_t cur)
+{
+  while (n[cur].left != IDX_RBTREE_NIL)
+    cur = n[cur].left;
+  return cur;
+}
+
+/// @brief 최솟값 노드 인덱스, 빈 트리면 0
+uint32_t idx_rbtree_min(const idx_rbtree *t)
+{
+  if (idx_file_refresh(t) != 0)
+    return IDX_RBTREE_NIL;
+  if (t->img->root == IDX_RBTREE_NIL)
+    return IDX_RBTREE_NIL;
+  return idx_min_subtree(t->img->nodes, t->img->root);
+}
+
+/// @brief 최댓값 노드 인덱스, 빈 트리면 0
+uint32_t idx_rbtree_max(const idx_rbtree *t)
+{
+  if (idx_file_refresh(t) != 0)
+    return IDX_RBTREE_NIL;
+
+  const idx_node_t *n = t->img->nodes;
+  uint32_t cur = t->img->root;
+
+  if (cur == IDX_RBTREE_NIL)
+    return IDX_RBTREE_NIL;
+
+  while (n[cur].right != IDX_RBTREE_NIL)
+    cur = n[cur].right;
+  return cur;
+}
+
+/// @brief u 자리에 v를 연결하는 함수 (v가 nil이어도 부모를 기록)
+static void idx_transplant(idx_rbtree_image *img, uint32_t u, uint32_t v)
+{
+  idx_node_t *n = img->nodes;
+  uint32_t p = idx_parent(n, u);
+
+  if (p == IDX_RBTREE_NIL)
+    img->root = v;
+  else if (u == n[p].left)
+    n[p].left = v;
+  else
+    n[p].right = v;
+
+  idx_set_parent(n, v, p);
+}
+
+/// @brief 삭제 후 밸런싱 (rbtree_delete_fixup과 같은 case 구성)
+/// @param img 트리 이미지
+/// @param x 불균형이 발생한 노드 인덱스 (nil일 수 있음)
+static void idx_delete_fixup(idx_rbtree_image *img, uint32_t x)
+{
+  idx_node_t *n = img->nodes;
+
+  while (x != img->root && idx_color(n, x) == RBTREE_BLACK)
+  {
+    uint32_t p = idx_parent(n, x);
+
+    if (x == n[p].left)
+    {
+      uint32_t w = n[p].right; // 형제 노드
+
+      if (idx_color(n, w) == RBTREE_RED) // case 1: 형제가 RED
+      {
+        idx_set_color(n, w, RBTREE_BLACK);
+        idx_set_color(n, p, RBTREE_RED);
+        idx_left_rotate(img, p);
+        w = n[p].right;
+      }
+
+      if (idx_color(n, n[w].left) == RBTREE_BLACK && idx_color(n, n[w].right) == RBTREE_BLACK) // case 2
+      {
+        idx_set_color(n, w, RBTREE_RED);
+        x = p;
+      }
+      else
+      {
+        if (idx_color(n, n[w].right) == RBTREE_BLACK) // case 3
+        {
+          idx_set_color(n, n[w].left, RBTREE_BLACK);
+          idx_set_color(n, w, RBTREE_RED);
+          idx_right_rotate(img, w);
+          w = n[p].right;
+        }
+
+        // case 4
+        idx_set_color(n, w, idx_color(n, p));
+        idx_set_color(n, p, RBTREE_BLACK);
+        idx_set_color(n, n[w].right, RBTREE_BLACK);
+        idx_left_rotate(img, p);
+        x = img->root;
+      }
+    }
+    else // 좌우 대칭
+    {
+      uint32_t w = n[p].left;
+
+      if (idx_color(n, w) == RBTREE_RED)
+      {
+        idx_set_color(n, w, RBTREE_BLACK);
+        idx_set_color(n, p, RBTREE_RED);
+        idx_right_rotate(img, p);
+        w = n[p].left;
+      }
+
+      if (idx_color(n, n[w].right) == RBTREE_BLACK && idx_color(n, n[w].left) == RBTREE_BLACK)
+      {
+        idx_set_color(n, w, RBTREE_RED);
+        x = p;
+      }
+      else
+      {
+        if (idx_color(n, n[w].left) == RBTREE_BLACK)
+        {
+          idx_set_color(n, n[w].right, RBTREE_BLACK);
+          idx_set_color(n, w, RBTREE_RED);
+          idx_left_rotate(img, w);
+          w = n[p].left;
+        }
+
+        idx_set_color(n, w, idx_color(n, p));
+        idx_set_color(n, p, RBTREE_BLACK);
+        idx_set_color(n, n[w].left, RBTREE_BLACK);
+        idx_right_rotate(img, p);
+        x = img->root;
+      }
+    }
+  }
+
+  idx_set_color(n, x, RBTREE_BLACK);
+}
+
+/// @brief 노드 삭제 함수 (슬롯은 free list로 반환)
+/// @param t 트리 포인터
+/// @param z 삭제할 노드 인덱스
+/// @return 성공 시 0, 읽기 전용 파일이면 -1
+int idx_rbtree_erase(idx_rbtree *t, uint32_t z)
+{
+  if (t->readonly)
+    return -1;
+
+  idx_rbtree_image *img = t->img;
+  idx_node_t *n = img->nodes;
+  uint32_t y = z;
+  color_t origin_color = idx_color(n, y);
+  uint32_t x;
+
+  if (n[z].left == IDX_RBTREE_NIL) // 왼쪽 자식이 없는 경우
+  {
+    x = n[z].right;
+    idx_transplant(img, z, x);
+  }
+  else if (n[z].right == IDX_RBTREE_NIL) // 오른쪽 자식이 없는 경우
+  {
+    x = n[z].left;
+    idx_transplant(img, z, x);
+  }
+  else // 자식이 둘 다 있으면 후속자로 대체
+  {
+    y = idx_min_subtree(n, n[z].right);
+    origin_color = idx_color(n, y);
+    x = n[y].right;
+
+    if (y != n[z].right)
+    {
+      idx_transplant(img, y, x);
+      n[y].right = n[z].right;
+      idx_set_parent(n, n[y].right, y);
+    }
+    else
+      idx_set_parent(n, x, y);
+
+    idx_transplant(img, z, y);
+    n[y].left = n[z].left;
+    idx_set_parent(n, n[y].left, y);
+    idx_set_color(n, y, idx_color(n, z));
+  }
+
+  if (origin_color == RBTREE_BLACK)
+    idx_delete_fixup(img, x);
+
+  n[z].right = img->free_list; // 슬롯을 free list 맨 앞에 연결
+  img->free_list = z;
+  return 0;
+}
+
+/// @brief 중위 순회하며 키 값을 배열에 저장하는 함수 (부모 인덱스를 따라가는 반복문)
+/// @param t 대상 트리 포인터
+/// @param arr 결과 저장할 배열 포인터
+/// @param n 배열 크기
+/// @return 성공 시 0
+int idx_rbtree_to_array(const idx_rbtree *t, key_t *arr, const size_t n)
+{
+  if (idx_file_refresh(t) != 0)
+    return -1;
+
+  const idx_node_t *nodes = t->img->nodes;
+  uint32_t cur = t->img->root;
+  size_t i = 0;
+
+  if (cur == IDX_RBTREE_NIL)
+    return 0;
+
+  cur = idx_min_subtree(nodes, cur);
+  while (i < n && cur != IDX_RBTREE_NIL)
+  {
+    arr[i++] = nodes[cur].key;
+
+    if (nodes[cur].right != IDX_RBTREE_NIL)
+    {
+      cur = idx_min_subtree(nodes, nodes[cur].right);
+      continue;
+    }
+
+    // 왼쪽 자식인 조상을 만날 때까지 올라감 (루트의 부모는 nil)
+    uint32_t p = idx_parent(nodes, cur);
+    while (p != IDX_RBTREE_NIL && cur == nodes[p].right)
+    {
+      cur = p;
+      p = idx_parent(nodes, p);
+    }
+    cur = p;
+  }
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef _RBTREE_IDX_H_
+#define _RBTREE_IDX_H_
+
+#include "rbtree.h"
+#include <stdint.h>
+
+// 포인터 대신 32비트 인덱스로 연결하는 노드 (16바이트)
+// 인덱스 0은 nil sentinel이며, 색은 parent_color의 최하위 비트에 저장 (0: RED, 1: BLACK)
+typedef struct {
+  key_t key;
+  uint32_t left, right;
+  uint32_t parent_color;  // (부모 인덱스 << 1) | 색
+} idx_node_t;
+
+// 트리 전체를 담는 하나의 연속 메모리 블록
+// 내부에 포인터가 없으므로 memcpy나 파일 쓰기로 그대로 옮길 수 있음
+typedef struct {
+  uint32_t root;       // 루트 노드 인덱스 (빈 트리면 0)
+  uint32_t free_list;  // erase된 노드 인덱스 목록 (right로 연결, 없으면 0)
+  uint32_t used;       // 지금까지 사용한 슬롯 수 (nil 포함)
+  uint32_t cap;        // 할당된 슬롯 수
+  idx_node_t nodes[];  // 노드 배열, nodes[0]은 nil
+} idx_rbtree_image;
+
+typedef struct {
+  idx_rbtree_image *img;
+  void *map;        // 파일에 매핑된 트리면 매핑 시작 주소 (파일 헤더), 메모리에만 있으면 NULL
+  size_t map_size;  // 매핑한 파일 크기
+  int fd;           // 매핑한 파일 디스크립터
+  int readonly;     // 읽기 전용으로 연 파일이면 1 (삽입 / 삭제 불가)
+} idx_rbtree;
+
+// idx_rbtree_open으로 여는 파일의 맨 앞 헤더, 바로 뒤에 idx_rbtree_image가 그대로 놓임
+typedef struct {
+  char magic[8];      // IDX_RBTREE_FILE_MAGIC
+  uint32_t version;   // IDX_RBTREE_FILE_VERSION
+  uint32_t key_size;  // sizeof(key_t)
+} idx_rbtree_file_header;
+
+#define IDX_RBTREE_NIL 0
+#define IDX_RBTREE_MAX_NODES (UINT32_MAX >> 1)  // 부모 인덱스가 31비트에 들어가야 함
+#define IDX_RBTREE_FILE_MAGIC "RBTIDX1"  // NUL 포함 8바이트
+#define IDX_RBTREE_FILE_VERSION 1
+#define IDX_RBTREE_FILE_CHUNK (1u << 20)  // 파일을 늘릴 때 한 번에 추가하는 최대 슬롯 수 (16MiB)
+
+idx_rbtree *new_idx_rbtree(void);
+idx_rbtree *idx_rbtree_from_image(const idx_rbtree_image *img);
+size_t idx_rbtree_image_size(const idx_rbtree *t);
+void delete_idx_rbtree(idx_rbtree *t);
+idx_rbtree *idx_rbtree_open(const char *path, const int readonly);
+int idx_rbtree_sync(idx_rbtree *t);
+
+uint32_t idx_rbtree_insert(idx_rbtree *t, const key_t key);
+uint32_t idx_rbtree_find(const idx_rbtree *t, const key_t key);
+uint32_t idx_rbtree_min(const idx_rbtree *t);
+uint32_t idx_rbtree_max(const idx_rbtree *t);
+int idx_rbtree_erase(idx_rbtree *t, uint32_t node);
+int idx_rbtree_to_array(const idx_rbtree *t, key_t *arr, const size_t n);
+
+#endif  // _RBTREE_IDX_H_
@@ -0,0 +1,156 @@
+#include "rbtree_snapshot.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_BUF_BYTES (1 << 20)  // 한 번에 write하는 크기
+
+// 키 배열의 체크섬 (Fletcher 방식: 32비트 단어의 합과 합의 합, 2^64로 나머지)
+typedef struct {
+  uint64_t a, b;
+} snapshot_sum;
+
+static void snapshot_sum_init(snapshot_sum *s, uint64_t count)
+{
+  s->a = count; // 키 수가 다르면 같은 키 배열이라도 체크섬이 다르도록
+  s->b = 0;
+}
+
+static inline void snapshot_sum_add(snapshot_sum *s, const key_t *keys, size_t n)
+{
+  uint64_t a = s->a, b = s->b;
+  for (size_t i = 0; i < n; i++)
+  {
+    a += (uint32_t)keys[i];
+    b += a;
+  }
+  s->a = a;
+  s->b = b;
+}
+
+static uint64_t snapshot_sum_final(const snapshot_sum *s)
+{
+  return s->b ^ (s->a << 32 | s->a >> 32);
+}
+
+/// @brief 버퍼를 끝까지 쓰는 함수 (짧은 쓰기와 EINTR이면 이어서 씀)
+/// @return 성공 시 0, 실패 시 -1
+static int snapshot_write_all(int fd, const char *buf, size_t len)
+{
+  while (len > 0)
+  {
+    ssize_t w = write(fd, buf, len);
+    if (w < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+    buf += w;
+    len -= (size_t)w;
+  }
+  return 0;
+}
+
+/// @brief 트리의 키를 순서대로 스냅샷 파일에 쓰는 함수 (O(n), 큰 버퍼 단위로 write)
+/// @param t 대상 트리 포인터
+/// @param fd 쓰기용 파일 디스크립터 (현재 위치부터 씀, 파이프도 가능)
+/// @return 성공 시 0, 메모리 할당이나 쓰기 실패 시 -1
+/// @note RBTREE_MULTISET이면 같은 키를 개수만큼 풀어서 씀 (rbtree_load가 다시 합침)
+int rbtree_save(rbtree *t, int fd)
+{
+  char *buf = malloc(SNAPSHOT_BUF_BYTES);
+  if (buf == NULL) // 메모리 할당 실패 시
+    return -1;
+
+  rbtree_snapshot_header header = {.magic = RBTREE_SNAPSHOT_MAGIC, .version = RBTREE_SNAPSHOT_VERSION,
+                                   .key_size = sizeof(key_t), .byte_order = RBTREE_SNAPSHOT_BYTE_ORDER,
+                                   .count = rbtree_size(t)};
+  memcpy(buf, &header, sizeof(header));
+
+  snapshot_sum sum;
+  snapshot_sum_init(&sum, header.count);
+  const size_t cap = SNAPSHOT_BUF_BYTES / sizeof(key_t);
+  key_t *keys = (key_t *)buf;
+  size_t k = sizeof(header) / sizeof(key_t); // 첫 버퍼는 헤더 뒤부터 키를 채움
+  size_t start = k;                          // 체크섬에 아직 더하지 않은 첫 키
+
+  for (node_t *cur = rbtree_min(t); cur != NULL; cur = rbtree_next(t, cur))
+  {
+    for (unsigned int c = 0; c < rbtree_weight(cur); c++)
+    {
+      if (k == cap) // 버퍼가 차면 체크섬에 더하고 씀
+      {
+        snapshot_sum_add(&sum, keys + start, k - start);
+        if (snapshot_write_all(fd, buf, k * sizeof(key_t)) != 0)
+        {
+          free(buf);
+          return -1;
+        }
+        k = start = 0;
+      }
+      keys[k++] = cur->key;
+    }
+  }
+
+  // 남은 키와 체크섬
+  snapshot_sum_add(&sum, keys + start, k - start);
+  uint64_t checksum = snapshot_sum_final(&sum);
+  int ret = snapshot_write_all(fd, buf, k * sizeof(key_t));
+  if (ret == 0)
+    ret = snapshot_write_all(fd, (const char *)&checksum, sizeof(checksum));
+  free(buf);
+  return ret;
+}
+
+/// @brief 스냅샷 파일을 mmap해서 트리를 O(n)에 다시 만드는 함수 (키마다 삽입하거나 회전하지 않음)
+/// @param fd 읽기용 파일 디스크립터 (파일 전체가 스냅샷 하나여야 함)
+/// @return 생성된 트리 포인터, 형식 / 버전 / 바이트 순서 / 체크섬이 맞지 않거나 mmap, 메모리 할당 실패 시 NULL
+rbtree *rbtree_load(int fd)
+{
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(rbtree_snapshot_header) + sizeof(uint64_t))
+    return NULL;
+
+  size_t size = (size_t)st.st_size;
+  const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED)
+    return NULL;
+  madvise((void *)data, size, MADV_SEQUENTIAL);
+
+  rbtree *t = NULL;
+  rbtree_snapshot_header header;
+  memcpy(&header, data, sizeof(header));
+  const size_t body = size - sizeof(header) - sizeof(uint64_t);
+
+  // 헤더와 파일 크기 확인
+  if (memcmp(header.magic, RBTREE_SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 && header.version == RBTREE_SNAPSHOT_VERSION &&
+      header.key_size == sizeof(key_t) && header.byte_order == RBTREE_SNAPSHOT_BYTE_ORDER && header.count == body / sizeof(key_t) && body % sizeof(key_t) == 0)
+  {
+    const key_t *keys = (const key_t *)(data + sizeof(header)); // mmap은 페이지 정렬, 헤더는 키 크기의 배수
+    size_t n = (size_t)header.count;
+    uint64_t checksum;
+    memcpy(&checksum, data + sizeof(header) + body, sizeof(checksum));
+
+    // 체크섬과 정렬 여부를 한 번에 확인 (파일을 한 번만 훑음)
+    snapshot_sum sum;
+    snapshot_sum_init(&sum, header.count);
+    int sorted = 1;
+    for (size_t i = 0; i < n; i += SNAPSHOT_BUF_BYTES / sizeof(key_t))
+    {
+      size_t m = n - i < SNAPSHOT_BUF_BYTES / sizeof(key_t) ? n - i : SNAPSHOT_BUF_BYTES / sizeof(key_t);
+      snapshot_sum_add(&sum, keys + i, m);
+      for (size_t j = i > 0 ? i : 1; j < i + m; j++)
+        sorted &= keys[j - 1] <= keys[j];
+    }
+
+    if (sorted && snapshot_sum_final(&sum) == checksum)
+      t = rbtree_from_sorted(keys, n);
+  }
+
+  munmap((void *)data, size);
+  return t;
+}
@@ -0,0 +1,27 @@
+#ifndef _RBTREE_SNAPSHOT_H_
+#define _RBTREE_SNAPSHOT_H_
+
+#include "rbtree.h"
+#include <stdint.h>
+
+#define RBTREE_SNAPSHOT_MAGIC "RBTSNAP"  // 파일 맨 앞 8바이트 (NUL 포함)
+#define RBTREE_SNAPSHOT_VERSION 2
+#define RBTREE_SNAPSHOT_BYTE_ORDER 0x01020304u  // 쓴 기계의 바이트 순서로 저장, 다른 순서의 기계에서는 뒤집혀 보임
+
+// 스냅샷 파일 형식 (모두 쓴 기계의 바이트 순서, 변환 없이 mmap한 키를 바로 쓰기 위함)
+// [헤더 32바이트][키 count개, 오름차순, 같은 키는 개수만큼 반복][체크섬 8바이트]
+// 키만 있는 평평한 배열이므로 빌드 옵션(RBTREE_MULTISET 등)이 달라도 서로 읽을 수 있지만,
+// 바이트 순서가 다른 기계에서 쓴 파일은 byte_order가 맞지 않으므로 거부함
+typedef struct {
+  char magic[8];        // RBTREE_SNAPSHOT_MAGIC
+  uint32_t version;     // RBTREE_SNAPSHOT_VERSION
+  uint32_t key_size;    // sizeof(key_t)
+  uint32_t byte_order;  // RBTREE_SNAPSHOT_BYTE_ORDER
+  uint32_t reserved;    // 0 (count를 8바이트 경계에 맞춤)
+  uint64_t count;       // 키 수 (중복 포함)
+} rbtree_snapshot_header;
+
+int rbtree_save(rbtree *t, int fd);
+rbtree *rbtree_load(int fd);
+
+#endif  // _RBTREE_SNAPSHOT_H_
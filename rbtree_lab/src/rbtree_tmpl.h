@@ -0,0 +1,392 @@
+#ifndef _RBTREE_TMPL_H_
+#define _RBTREE_TMPL_H_
+
+#include "rbtree.h"
+#include <stdlib.h>
+
+// 키 타입, 값 타입, 비교 함수별로 특수화된 레드블랙트리를 만들어 주는 매크로 템플릿
+//
+//   static inline int cmp_u64(uint64_t a, uint64_t b) { return (a > b) - (a < b); }
+//   RBTREE_DEFINE(u64map, uint64_t, struct rec, cmp_u64)
+//
+// 위와 같이 쓰면 u64map(트리), u64map_node(노드) 타입과
+// u64map_new, u64map_insert, u64map_find, u64map_erase ... 함수들이 생성된다.
+// cmp(a, b)는 a < b이면 음수, 같으면 0, a > b이면 양수를 반환해야 하며
+// 생성된 함수 안에서 직접 호출되므로 함수 포인터 없이 인라인된다.
+// 알고리즘은 rbtree.c와 같고 (sentinel nil, 중복 키는 오른쪽에 삽입) 노드마다 값을 함께 저장한다.
+
+#define RBTREE_DEFINE(name, K, V, cmp)                                                        \
+                                                                                              \
+  typedef struct name##_node {                                                                \
+    color_t color;                                                                            \
+    K key;                                                                                    \
+    V value;                                                                                  \
+    struct name##_node *parent, *left, *right;                                                \
+  } name##_node;                                                                              \
+                                                                                              \
+  typedef struct {                                                                            \
+    name##_node *root;                                                                        \
+    name##_node *nil;                                                                         \
+  } name;                                                                                     \
+                                                                                              \
+  /* 트리 생성 및 초기화, 메모리 할당 실패 시 NULL */                                          \
+  static inline name *name##_new(void)                                                        \
+  {                                                                                           \
+    name *t = (name *)calloc(1, sizeof(name));                                                \
+    if (t == NULL)                                                                            \
+      return NULL;                                                                            \
+                                                                                              \
+    name##_node *nil = (name##_node *)calloc(1, sizeof(name##_node));                         \
+    if (nil == NULL)                                                                          \
+    {                                                                                         \
+      free(t);                                                                                \
+      return NULL;                                                                            \
+    }                                                                                         \
+                                                                                              \
+    nil->color = RBTREE_BLACK;                                                                \
+    nil->left = nil->right = nil->parent = nil;                                               \
+    t->nil = nil;                                                                             \
+    t->root = nil;                                                                            \
+    return t;                                                                                 \
+  }                                                                                           \
+                                                                                              \
+  /* 트리와 모든 노드의 메모리 해제 (왼쪽 자식을 회전으로 올리며 스택 없이 해제) */               \
+  static inline void name##_delete(name *t)                                                   \
+  {                                                                                           \
+    name##_node *cur = t->root;                                                               \
+    while (cur != t->nil)                                                                     \
+    {                                                                                         \
+      if (cur->left == t->nil)                                                                \
+      {                                                                                       \
+        name##_node *next = cur->right;                                                       \
+        free(cur);                                                                            \
+        cur = next;                                                                           \
+      }                                                                                       \
+      else                                                                                    \
+      {                                                                                       \
+        name##_node *left = cur->left;                                                        \
+        cur->left = left->right;                                                              \
+        left->right = cur;                                                                    \
+        cur = left;                                                                           \
+      }                                                                                       \
+    }                                                                                         \
+    free(t->nil);                                                                             \
+    free(t);                                                                                  \
+  }                                                                                           \
+                                                                                              \
+  static inline void name##_left_rotate(name *t, name##_node *x)                              \
+  {                                                                                           \
+    name##_node *y = x->right;                                                                \
+    x->right = y->left;                                                                       \
+    if (y->left != t->nil)                                                                    \
+      y->left->parent = x;                                                                    \
+    y->parent = x->parent;                                                                    \
+    if (x->parent == t->nil)                                                                  \
+      t->root = y;                                                                            \
+    else if (x == x->parent->left)                                                            \
+      x->parent->left = y;                                                                    \
+    else                                                                                      \
+      x->parent->right = y;                                                                   \
+    y->left = x;                                                                              \
+    x->parent = y;                                                                            \
+  }                                                                                           \
+                                                                                              \
+  static inline void name##_right_rotate(name *t, name##_node *x)                             \
+  {                                                                                           \
+    name##_node *y = x->left;                                                                 \
+    x->left = y->right;                                                                       \
+    if (y->right != t->nil)                                                                   \
+      y->right->parent = x;                                                                   \
+    y->parent = x->parent;                                                                    \
+    if (x->parent == t->nil)                                                                  \
+      t->root = y;                                                                            \
+    else if (x == x->parent->right)                                                           \
+      x->parent->right = y;                                                                   \
+    else                                                                                      \
+      x->parent->left = y;                                                                    \
+    y->right = x;                                                                             \
+    x->parent = y;                                                                            \
+  }                                                                                           \
+                                                                                              \
+  static inline void name##_insert_fixup(name *t, name##_node *cur)                           \
+  {                                                                                           \
+    while (cur->parent->color == RBTREE_RED)                                                  \
+    {                                                                                         \
+      name##_node *grand = cur->parent->parent;                                               \
+      if (cur->parent == grand->left)                                                         \
+      {                                                                                       \
+        name##_node *uncle = grand->right;                                                    \
+        if (uncle->color == RBTREE_RED)                                                       \
+        {                                                                                     \
+          cur->parent->color = RBTREE_BLACK;                                                  \
+          uncle->color = RBTREE_BLACK;                                                        \
+          grand->color = RBTREE_RED;                                                          \
+          cur = grand;                                                                        \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+          if (cur == cur->parent->right)                                                      \
+          {                                                                                   \
+            cur = cur->parent;                                                                \
+            name##_left_rotate(t, cur);                                                       \
+          }                                                                                   \
+          cur->parent->color = RBTREE_BLACK;                                                  \
+          cur->parent->parent->color = RBTREE_RED;                                            \
+          name##_right_rotate(t, cur->parent->parent);                                        \
+        }                                                                                     \
+      }                                                                                       \
+      else                                                                                    \
+      {                                                                                       \
+        name##_node *uncle = grand->left;                                                     \
+        if (uncle->color == RBTREE_RED)                                                       \
+        {                                                                                     \
+          cur->parent->color = RBTREE_BLACK;                                                  \
+          uncle->color = RBTREE_BLACK;                                                        \
+          grand->color = RBTREE_RED;                                                          \
+          cur = grand;                                                                        \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+          if (cur == cur->parent->left)                                                       \
+          {                                                                                   \
+            cur = cur->parent;                                                                \
+            name##_right_rotate(t, cur);                                                      \
+          }                                                                                   \
+          cur->parent->color = RBTREE_BLACK;                                                  \
+          cur->parent->parent->color = RBTREE_RED;                                            \
+          name##_left_rotate(t, cur->parent->parent);                                         \
+        }                                                                                     \
+      }                                                                                       \
+    }                                                                                         \
+    t->root->color = RBTREE_BLACK;                                                            \
+  }                                                                                           \
+                                                                                              \
+  /* key, value 삽입 (중복 키 허용), 메모리 할당 실패 시 NULL */                               \
+  static inline name##_node *name##_insert(name *t, K key, V value)                           \
+  {                                                                                           \
+    name##_node *cur = (name##_node *)calloc(1, sizeof(name##_node));                         \
+    if (cur == NULL)                                                                          \
+      return NULL;                                                                            \
+    cur->color = RBTREE_RED;                                                                  \
+    cur->key = key;                                                                           \
+    cur->value = value;                                                                       \
+    cur->left = cur->right = t->nil;                                                          \
+                                                                                              \
+    name##_node *parent = t->nil;                                                             \
+    name##_node *pos = t->root;                                                               \
+    int c = 0;                                                                                \
+    while (pos != t->nil)                                                                     \
+    {                                                                                         \
+      parent = pos;                                                                           \
+      c = cmp(key, pos->key);                                                                 \
+      pos = c < 0 ? pos->left : pos->right;                                                   \
+    }                                                                                         \
+                                                                                              \
+    cur->parent = parent;                                                                     \
+    if (parent == t->nil)                                                                     \
+      t->root = cur;                                                                          \
+    else if (c < 0)                                                                           \
+      parent->left = cur;                                                                     \
+    else                                                                                      \
+      parent->right = cur;                                                                    \
+                                                                                              \
+    name##_insert_fixup(t, cur);                                                              \
+    return cur;                                                                               \
+  }                                                                                           \
+                                                                                              \
+  /* key를 가진 노드 탐색, 없으면 NULL */                                                      \
+  static inline name##_node *name##_find(const name *t, K key)                                \
+  {                                                                                           \
+    name##_node *cur = t->root;                                                               \
+    while (cur != t->nil)                                                                     \
+    {                                                                                         \
+      int c = cmp(key, cur->key);                                                             \
+      if (c < 0)                                                                              \
+        cur = cur->left;                                                                      \
+      else if (c > 0)                                                                         \
+        cur = cur->right;                                                                     \
+      else                                                                                    \
+        return cur;                                                                           \
+    }                                                                                         \
+    return NULL;                                                                              \
+  }                                                                                           \
+                                                                                              \
+  /* key 이상인 첫 번째 노드, 없으면 NULL */                                                   \
+  static inline name##_node *name##_lower_bound(const name *t, K key)                         \
+  {                                                                                           \
+    name##_node *cur = t->root;                                                               \
+    name##_node *found = NULL;                                                                \
+    while (cur != t->nil)                                                                     \
+    {                                                                                         \
+      if (cmp(cur->key, key) >= 0)                                                            \
+      {                                                                                       \
+        found = cur;                                                                          \
+        cur = cur->left;                                                                      \
+      }                                                                                       \
+      else                                                                                    \
+        cur = cur->right;                                                                     \
+    }                                                                                         \
+    return found;                                                                             \
+  }                                                                                           \
+                                                                                              \
+  static inline name##_node *name##_min_subtree(const name *t, name##_node *cur)              \
+  {                                                                                           \
+    while (cur->left != t->nil)                                                               \
+      cur = cur->left;                                                                        \
+    return cur;                                                                               \
+  }                                                                                           \
+                                                                                              \
+  /* 최소 노드, 트리가 비어있으면 NULL */                                                      \
+  static inline name##_node *name##_min(const name *t)                                        \
+  {                                                                                           \
+    return t->root == t->nil ? NULL : name##_min_subtree(t, t->root);                         \
+  }                                                                                           \
+                                                                                              \
+  /* 최대 노드, 트리가 비어있으면 NULL */                                                      \
+  static inline name##_node *name##_max(const name *t)                                        \
+  {                                                                                           \
+    name##_node *cur = t->root;                                                               \
+    if (cur == t->nil)                                                                        \
+      return NULL;                                                                            \
+    while (cur->right != t->nil)                                                              \
+      cur = cur->right;                                                                       \
+    return cur;                                                                               \
+  }                                                                                           \
+                                                                                              \
+  /* 중위 순회 기준 다음 노드, 마지막이면 NULL */                                              \
+  static inline name##_node *name##_next(const name *t, name##_node *node)                    \
+  {                                                                                           \
+    if (node->right != t->nil)                                                                \
+      return name##_min_subtree(t, node->right);                                              \
+    name##_node *parent = node->parent;                                                       \
+    while (parent != t->nil && node == parent->right)                                         \
+    {                                                                                         \
+      node = parent;                                                                          \
+      parent = parent->parent;                                                                \
+    }                                                                                         \
+    return parent == t->nil ? NULL : parent;                                                  \
+  }                                                                                           \
+                                                                                              \
+  static inline void name##_transplant(name *t, name##_node *u, name##_node *v)               \
+  {                                                                                           \
+    if (u->parent == t->nil)                                                                  \
+      t->root = v;                                                                            \
+    else if (u == u->parent->left)                                                            \
+      u->parent->left = v;                                                                    \
+    else                                                                                      \
+      u->parent->right = v;                                                                   \
+    v->parent = u->parent;                                                                    \
+  }                                                                                           \
+                                                                                              \
+  static inline void name##_delete_fixup(name *t, name##_node *x)                             \
+  {                                                                                           \
+    while (x != t->root && x->color == RBTREE_BLACK)                                          \
+    {                                                                                         \
+      if (x == x->parent->left)                                                               \
+      {                                                                                       \
+        name##_node *w = x->parent->right;                                                    \
+        if (w->color == RBTREE_RED)                                                           \
+        {                                                                                     \
+          w->color = RBTREE_BLACK;                                                            \
+          x->parent->color = RBTREE_RED;                                                      \
+          name##_left_rotate(t, x->parent);                                                   \
+          w = x->parent->right;                                                               \
+        }                                                                                     \
+        if (w->left->color == RBTREE_BLACK && w->right->color == RBTREE_BLACK)                \
+        {                                                                                     \
+          w->color = RBTREE_RED;                                                              \
+          x = x->parent;                                                                      \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+          if (w->right->color == RBTREE_BLACK)                                                \
+          {                                                                                   \
+            w->left->color = RBTREE_BLACK;                                                    \
+            w->color = RBTREE_RED;                                                            \
+            name##_right_rotate(t, w);                                                        \
+            w = x->parent->right;                                                             \
+          }                                                                                   \
+          w->color = x->parent->color;                                                        \
+          x->parent->color = RBTREE_BLACK;                                                    \
+          w->right->color = RBTREE_BLACK;                                                     \
+          name##_left_rotate(t, x->parent);                                                   \
+          x = t->root;                                                                        \
+        }                                                                                     \
+      }                                                                                       \
+      else                                                                                    \
+      {                                                                                       \
+        name##_node *w = x->parent->left;                                                     \
+        if (w->color == RBTREE_RED)                                                           \
+        {                                                                                     \
+          w->color = RBTREE_BLACK;                                                            \
+          x->parent->color = RBTREE_RED;                                                      \
+          name##_right_rotate(t, x->parent);                                                  \
+          w = x->parent->left;                                                                \
+        }                                                                                     \
+        if (w->right->color == RBTREE_BLACK && w->left->color == RBTREE_BLACK)                \
+        {                                                                                     \
+          w->color = RBTREE_RED;                                                              \
+          x = x->parent;                                                                      \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+          if (w->left->color == RBTREE_BLACK)                                                 \
+          {                                                                                   \
+            w->right->color = RBTREE_BLACK;                                                   \
+            w->color = RBTREE_RED;                                                            \
+            name##_left_rotate(t, w);                                                         \
+            w = x->parent->left;                                                              \
+          }                                                                                   \
+          w->color = x->parent->color;                                                        \
+          x->parent->color = RBTREE_BLACK;                                                    \
+          w->left->color = RBTREE_BLACK;                                                      \
+          name##_right_rotate(t, x->parent);                                                  \
+          x = t->root;                                                                        \
+        }                                                                                     \
+      }                                                                                       \
+    }                                                                                         \
+    x->color = RBTREE_BLACK;                                                                  \
+  }                                                                                           \
+                                                                                              \
+  /* 노드 삭제 및 메모리 해제 */                                                               \
+  static inline void name##_erase(name *t, name##_node *z)                                    \
+  {                                                                                           \
+    name##_node *y = z;                                                                       \
+    color_t origin_color = y->color;                                                          \
+    name##_node *x;                                                                           \
+                                                                                              \
+    if (z->left == t->nil)                                                                    \
+    {                                                                                         \
+      x = z->right;                                                                           \
+      name##_transplant(t, z, z->right);                                                      \
+    }                                                                                         \
+    else if (z->right == t->nil)                                                              \
+    {                                                                                         \
+      x = z->left;                                                                            \
+      name##_transplant(t, z, z->left);                                                       \
+    }                                                                                         \
+    else                                                                                      \
+    {                                                                                         \
+      y = name##_min_subtree(t, z->right);                                                    \
+      origin_color = y->color;                                                                \
+      x = y->right;                                                                           \
+      if (y != z->right)                                                                      \
+      {                                                                                       \
+        name##_transplant(t, y, y->right);                                                    \
+        y->right = z->right;                                                                  \
+        y->right->parent = y;                                                                 \
+      }                                                                                       \
+      else                                                                                    \
+        x->parent = y;                                                                        \
+      name##_transplant(t, z, y);                                                             \
+      y->left = z->left;                                                                      \
+      y->left->parent = y;                                                                    \
+      y->color = z->color;                                                                    \
+    }                                                                                         \
+                                                                                              \
+    if (origin_color == RBTREE_BLACK)                                                         \
+      name##_delete_fixup(t, x);                                                              \
+    free(z);                                                                                  \
+  }
+
+#endif  // _RBTREE_TMPL_H_
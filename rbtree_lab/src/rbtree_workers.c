@@ -0,0 +1,268 @@
+#include "rbtree_workers.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define RBTREE_DEQUE_CAP 1024  // 워커 하나가 쌓아 둘 수 있는 작업 수 (넘치면 바로 실행)
+
+// 워커마다 하나씩 있는 작업 덱: 주인은 bottom 쪽에서 넣고 빼고, 다른 워커는 top 쪽에서 훔쳐 감
+typedef struct {
+  pthread_mutex_t lock;
+  size_t top, bottom;  // [top, bottom) 구간에 작업이 쌓여 있음 (인덱스는 RBTREE_DEQUE_CAP으로 나눈 나머지)
+  rbtree_task *tasks[RBTREE_DEQUE_CAP];
+} rbtree_deque;
+
+// 워커 스레드에 넘기는 인자
+typedef struct {
+  rbtree_workers *w;
+  unsigned int index;
+} rbtree_worker_arg;
+
+struct rbtree_workers {
+  unsigned int nthreads;  // 0번은 rbtree_workers_run을 호출한 스레드
+  pthread_t threads[RBTREE_WORKERS_MAX];
+  rbtree_worker_arg args[RBTREE_WORKERS_MAX];
+  rbtree_deque deques[RBTREE_WORKERS_MAX];
+  pthread_mutex_t lock;  // 아래 상태 변경과 대기를 보호
+  pthread_cond_t wake;   // run 시작 / 종료 요청 알림
+  atomic_int active;     // run 실행 중이면 1 (워커는 이 동안 작업을 훔치며 돌아감)
+  int stop;              // 1이면 워커 스레드 종료
+};
+
+// 현재 스레드가 어느 풀의 몇 번 워커인지
+static _Thread_local const rbtree_workers *self_pool;
+static _Thread_local unsigned int self_index;
+static _Thread_local uint64_t steal_seed;
+
+/// @brief 덱 맨 아래(주인 쪽)에 작업을 넣는 함수
+/// @return 성공 시 0, 덱이 가득 찼으면 -1
+static int rbtree_deque_push(rbtree_deque *d, rbtree_task *task)
+{
+  int ret = -1;
+
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom - d->top < RBTREE_DEQUE_CAP)
+  {
+    d->tasks[d->bottom++ % RBTREE_DEQUE_CAP] = task;
+    ret = 0;
+  }
+  pthread_mutex_unlock(&d->lock);
+  return ret;
+}
+
+/// @brief 덱 맨 아래(가장 최근에 넣은) 작업을 꺼내는 함수
+/// @return 꺼낸 작업, 비었으면 NULL
+static rbtree_task *rbtree_deque_pop(rbtree_deque *d)
+{
+  rbtree_task *task = NULL;
+
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom > d->top)
+    task = d->tasks[--d->bottom % RBTREE_DEQUE_CAP];
+  pthread_mutex_unlock(&d->lock);
+  return task;
+}
+
+/// @brief 덱 맨 위(가장 오래된, 보통 가장 큰) 작업을 훔쳐 오는 함수
+/// @return 훔친 작업, 비었으면 NULL
+static rbtree_task *rbtree_deque_steal(rbtree_deque *d)
+{
+  rbtree_task *task = NULL;
+
+  pthread_mutex_lock(&d->lock);
+  if (d->bottom > d->top)
+    task = d->tasks[d->top++ % RBTREE_DEQUE_CAP];
+  pthread_mutex_unlock(&d->lock);
+  return task;
+}
+
+/// @brief 작업을 실행하고 완료 표시하는 함수
+static void rbtree_task_execute(rbtree_task *task)
+{
+  task->fn(task);
+  atomic_store_explicit(&task->done, 1, memory_order_release); // 작업 결과가 wait하는 쪽에 보이도록
+}
+
+/// @brief 다른 워커의 덱에서 작업 하나를 훔쳐 오는 함수 (무작위 위치부터 한 바퀴)
+/// @param w 풀 포인터
+/// @param self 훔치는 워커 번호
+/// @return 훔친 작업, 없으면 NULL
+static rbtree_task *rbtree_workers_steal(rbtree_workers *w, unsigned int self)
+{
+  // xorshift로 시작 위치를 섞어서 여러 워커가 같은 덱에 몰리지 않게 함
+  steal_seed ^= steal_seed << 13;
+  steal_seed ^= steal_seed >> 7;
+  steal_seed ^= steal_seed << 17;
+  unsigned int start = (unsigned int)(steal_seed % w->nthreads);
+
+  for (unsigned int k = 0; k < w->nthreads; k++)
+  {
+    unsigned int victim = (start + k) % w->nthreads;
+    if (victim == self)
+      continue;
+    rbtree_task *task = rbtree_deque_steal(&w->deques[victim]);
+    if (task != NULL)
+      return task;
+  }
+  return NULL;
+}
+
+/// @brief 워커 스레드 본체: run이 실행 중인 동안 작업을 훔쳐 실행하고, 아니면 잠듦
+static void *rbtree_worker_main(void *p)
+{
+  rbtree_worker_arg *arg = (rbtree_worker_arg *)p;
+  rbtree_workers *w = arg->w;
+  self_pool = w;
+  self_index = arg->index;
+  steal_seed = 0x9E3779B97F4A7C15ull * (arg->index + 1);
+
+  pthread_mutex_lock(&w->lock);
+  while (!w->stop)
+  {
+    if (!atomic_load(&w->active))
+    {
+      pthread_cond_wait(&w->wake, &w->lock);
+      continue;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    while (atomic_load(&w->active))
+    {
+      rbtree_task *task = rbtree_workers_steal(w, arg->index);
+      if (task != NULL)
+        rbtree_task_execute(task);
+      else
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&w->lock);
+  }
+  pthread_mutex_unlock(&w->lock);
+  return NULL;
+}
+
+/// @brief 스레드 풀 생성 함수
+/// @param nthreads 전체 스레드 수 (rbtree_workers_run을 호출하는 스레드 포함, 1 ~ RBTREE_WORKERS_MAX)
+/// @return 생성된 풀 포인터, 실패 시 NULL
+rbtree_workers *rbtree_workers_new(unsigned int nthreads)
+{
+  if (nthreads == 0)
+    nthreads = 1;
+  if (nthreads > RBTREE_WORKERS_MAX)
+    nthreads = RBTREE_WORKERS_MAX;
+
+  rbtree_workers *w = (rbtree_workers *)calloc(1, sizeof(rbtree_workers));
+  if (w == NULL) // 메모리 할당 실패 시 NULL 반환
+    return NULL;
+
+  w->nthreads = 1; // 스레드 생성에 실패하면 지금까지 만든 만큼만 정리
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->wake, NULL);
+  for (unsigned int i = 0; i < nthreads; i++)
+    pthread_mutex_init(&w->deques[i].lock, NULL);
+
+  for (unsigned int i = 1; i < nthreads; i++)
+  {
+    w->args[i] = (rbtree_worker_arg){w, i};
+    if (pthread_create(&w->threads[i], NULL, rbtree_worker_main, &w->args[i]) != 0)
+    {
+      for (unsigned int j = i; j < nthreads; j++)
+        pthread_mutex_destroy(&w->deques[j].lock);
+      rbtree_workers_delete(w);
+      return NULL;
+    }
+    w->nthreads = i + 1;
+  }
+
+  return w;
+}
+
+/// @brief 스레드 풀을 종료하고 메모리 해제하는 함수
+/// @param w 해제할 풀 포인터
+void rbtree_workers_delete(rbtree_workers *w)
+{
+  pthread_mutex_lock(&w->lock);
+  w->stop = 1;
+  pthread_cond_broadcast(&w->wake);
+  pthread_mutex_unlock(&w->lock);
+
+  for (unsigned int i = 1; i < w->nthreads; i++)
+    pthread_join(w->threads[i], NULL);
+  for (unsigned int i = 0; i < w->nthreads; i++)
+    pthread_mutex_destroy(&w->deques[i].lock);
+  pthread_cond_destroy(&w->wake);
+  pthread_mutex_destroy(&w->lock);
+  free(w);
+}
+
+/// @brief 풀의 전체 스레드 수
+unsigned int rbtree_workers_count(const rbtree_workers *w)
+{
+  return w->nthreads;
+}
+
+/// @brief 현재 스레드의 워커 번호 (이 풀의 워커가 아니면 0)
+unsigned int rbtree_workers_self(const rbtree_workers *w)
+{
+  return self_pool == w ? self_index : 0;
+}
+
+/// @brief 호출한 스레드를 0번 워커로 삼아 task를 끝까지 실행하는 함수 (실행 중에는 다른 워커가 작업을 나눠 가짐)
+/// @param w 풀 포인터
+/// @param task 실행할 최상위 작업 (안에서 spawn한 작업은 모두 wait해야 함)
+/// @note 한 풀에서 동시에 하나의 run만 실행할 수 있음
+void rbtree_workers_run(rbtree_workers *w, rbtree_task *task)
+{
+  const rbtree_workers *prev_pool = self_pool;
+  unsigned int prev_index = self_index;
+  self_pool = w;
+  self_index = 0;
+  if (steal_seed == 0)
+    steal_seed = 0x9E3779B97F4A7C15ull;
+
+  if (w->nthreads > 1) // 잠든 워커를 깨움
+  {
+    pthread_mutex_lock(&w->lock);
+    atomic_store(&w->active, 1);
+    pthread_cond_broadcast(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+  }
+
+  rbtree_task_execute(task);
+  atomic_store(&w->active, 0); // 모든 작업이 wait로 끝났으므로 워커는 다시 잠듦
+
+  self_pool = prev_pool;
+  self_index = prev_index;
+}
+
+/// @brief 작업을 현재 워커의 덱에 넣어 다른 워커가 가져갈 수 있게 하는 함수
+/// @param w 풀 포인터
+/// @param task 실행할 작업 (rbtree_task_wait 전까지 살아 있어야 함)
+void rbtree_task_spawn(rbtree_workers *w, rbtree_task *task)
+{
+  atomic_store_explicit(&task->done, 0, memory_order_relaxed);
+  if (rbtree_deque_push(&w->deques[rbtree_workers_self(w)], task) != 0) // 덱이 가득 찼으면 바로 실행
+    rbtree_task_execute(task);
+}
+
+/// @brief 작업이 끝날 때까지 기다리는 함수 (기다리는 동안 다른 작업을 대신 실행)
+/// @param w 풀 포인터
+/// @param task spawn한 작업
+void rbtree_task_wait(rbtree_workers *w, rbtree_task *task)
+{
+  unsigned int self = rbtree_workers_self(w);
+
+  while (!atomic_load_explicit(&task->done, memory_order_acquire))
+  {
+    // 아직 아무도 가져가지 않았다면 자기 덱 맨 아래에 있으므로 보통 그대로 꺼내서 실행하게 됨
+    rbtree_task *other = rbtree_deque_pop(&w->deques[self]);
+    if (other == NULL)
+      other = rbtree_workers_steal(w, self);
+
+    if (other != NULL)
+      rbtree_task_execute(other);
+    else
+      sched_yield();
+  }
+}
@@ -0,0 +1,26 @@
+#ifndef _RBTREE_WORKERS_H_
+#define _RBTREE_WORKERS_H_
+
+#include <stdatomic.h>
+
+#define RBTREE_WORKERS_MAX 64  // 풀 하나의 최대 스레드 수
+
+// 워커가 실행할 작업 하나, 인자는 이 구조체를 멤버로 품은 구조체에 두고 rbtree_entry로 꺼냄
+typedef struct rbtree_task {
+  void (*fn)(struct rbtree_task *task);  // 실행할 함수
+  atomic_int done;                       // 실행이 끝나면 1
+} rbtree_task;
+
+// work-stealing 스레드 풀 (정의는 rbtree_workers.c)
+typedef struct rbtree_workers rbtree_workers;
+
+rbtree_workers *rbtree_workers_new(unsigned int nthreads);
+void rbtree_workers_delete(rbtree_workers *w);
+unsigned int rbtree_workers_count(const rbtree_workers *w);
+unsigned int rbtree_workers_self(const rbtree_workers *w);
+
+void rbtree_workers_run(rbtree_workers *w, rbtree_task *task);
+void rbtree_task_spawn(rbtree_workers *w, rbtree_task *task);
+void rbtree_task_wait(rbtree_workers *w, rbtree_task *task);
+
+#endif  // _RBTREE_WORKERS_H_
@@ -1,8 +1,18 @@
 #include <assert.h>
 #include "../src/rbtree.h"
+#include "../src/rbtree_tmpl.h"
+#include "../src/rbtree_idx.h"
+#include "../src/rbtree_frozen.h"
+#include "../src/rbtree_snapshot.h"
+#include "../src/rbtree_workers.h"
+#include <fcntl.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 // new_rbtree should return rbtree struct with null root node
 void test_init(void)
@@ -30,11 +40,11 @@ void test_insert_single(const key_t key)
 #ifdef SENTINEL
   assert(p->left == t->nil);
   assert(p->right == t->nil);
-  assert(p->parent == t->nil);
+  assert(rbtree_parent(p) == t->nil);
 #else
   assert(p->left == NULL);
   assert(p->right == NULL);
-  assert(p->parent == NULL);
+  assert(rbtree_parent(p) == NULL);
 #endif
   delete_rbtree(t);
 }
@@ -141,6 +151,80 @@ void test_minmax(key_t *arr, const size_t n)
   delete_rbtree(t);
 }
 
+// 캐시된 min/max가 실제로 트리를 끝까지 내려가서 찾은 노드와 같아야 함
+static void check_minmax_cache(const rbtree *t)
+{
+  node_t *lo = t->root, *hi = t->root;
+#ifdef SENTINEL
+  node_t *nil = t->nil;
+#else
+  node_t *nil = NULL;
+#endif
+  if (lo == nil)
+  {
+    assert(rbtree_min(t) == NULL);
+    assert(rbtree_max(t) == NULL);
+    return;
+  }
+  while (lo->left != nil)
+    lo = lo->left;
+  while (hi->right != nil)
+    hi = hi->right;
+  assert(rbtree_min(t) == lo);
+  assert(rbtree_max(t) == hi);
+}
+
+// pop_min / pop_max는 정렬 순서대로 키를 꺼내야 함 (타이머 큐 패턴)
+void test_pop_minmax(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  key_t key;
+  assert(rbtree_pop_min(t, &key) == -1);
+  assert(rbtree_pop_max(t, &key) == -1);
+
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+    rbtree_insert(t, arr[i]);
+    check_minmax_cache(t);
+  }
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  // 앞쪽 절반은 pop_min, 뒤쪽 절반은 pop_max로 꺼냄
+  size_t lo = 0, hi = n;
+  while (lo < hi)
+  {
+    if ((lo + n - hi) % 2 == 0)
+    {
+      assert(rbtree_pop_min(t, &key) == 0);
+      assert(key == arr[lo++]);
+    }
+    else
+    {
+      assert(rbtree_pop_max(t, &key) == 0);
+      assert(key == arr[--hi]);
+    }
+    check_minmax_cache(t);
+  }
+  assert(t->root == t->nil);
+
+  // 임의 노드 삭제와 섞어도 캐시가 유지되어야 함
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_insert(t, rand() % n);
+    if (i % 3 == 2)
+    {
+      rbtree_erase(t, t->root);
+    }
+    check_minmax_cache(t);
+  }
+
+  free(arr);
+  delete_rbtree(t);
+}
+
 void test_to_array(rbtree *t, const key_t *arr, const size_t n)
 {
   assert(t != NULL);
@@ -157,6 +241,247 @@ void test_to_array(rbtree *t, const key_t *arr, const size_t n)
   free(res);
 }
 
+// 배열이 트리보다 작으면 앞에서부터 n개만 채우고 나머지는 건드리지 않아야 함
+void test_to_array_partial()
+{
+  rbtree *t = new_rbtree();
+  assert(t != NULL);
+
+  key_t entries[] = {10, 5, 8, 34, 67, 23, 156, 24, 2, 12, 24, 36, 990, 25};
+  const size_t n = sizeof(entries) / sizeof(entries[0]);
+  insert_arr(t, entries, n);
+  qsort((void *)entries, n, sizeof(key_t), comp);
+
+  for (size_t m = 0; m <= n; m++)
+  {
+    key_t *res = calloc(n + 1, sizeof(key_t));
+    res[m] = -1;
+    rbtree_to_array(t, res, m);
+    for (size_t i = 0; i < m; i++)
+    {
+      assert(entries[i] == res[i]);
+    }
+    assert(res[m] == -1);
+    free(res);
+  }
+
+  delete_rbtree(t);
+}
+
+// next/prev와 커서는 중위 순회 순서대로 노드를 돌려줘야 함
+void test_cursor(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n / 2 + 1); // 중복 키 포함
+  }
+  insert_arr(t, arr, n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  // 최소 노드부터 정방향 (multiset이면 노드 하나가 같은 키 여러 개)
+  rbtree_cursor cur;
+  rbtree_cursor_init(&cur, t, rbtree_min(t));
+  size_t i = 0;
+  for (node_t *p = rbtree_cursor_next(&cur); p != NULL; p = rbtree_cursor_next(&cur))
+  {
+    assert(i < n);
+    assert(p->key == arr[i]);
+    i += rbtree_weight(p);
+  }
+  assert(i == n);
+
+  // 최대 노드부터 역방향
+  rbtree_cursor_init(&cur, t, rbtree_max(t));
+  for (node_t *p = rbtree_cursor_prev(&cur); p != NULL; p = rbtree_cursor_prev(&cur))
+  {
+    assert(i > 0);
+    assert(p->key == arr[i - 1]);
+    i -= rbtree_weight(p);
+  }
+  assert(i == 0);
+
+  // find로 찾은 중간 노드에서 시작해도 정렬 순서를 유지해야 함
+  node_t *p = rbtree_find(t, arr[n / 2]);
+  assert(p != NULL);
+  for (node_t *q = rbtree_next(t, p); q != NULL; p = q, q = rbtree_next(t, q))
+  {
+    assert(p->key <= q->key);
+    assert(rbtree_prev(t, q) == p);
+  }
+  assert(p == rbtree_max(t));
+
+  free(arr);
+  delete_rbtree(t);
+}
+
+// lower/upper bound와 range는 정렬된 배열에서 구한 결과와 같아야 함
+void test_bounds_range(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (2 * n); // 중복 및 빈 구간 포함
+  }
+  insert_arr(t, arr, n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  key_t *res = calloc(n, sizeof(key_t));
+  for (key_t key = -1; key <= (key_t)(2 * n); key++)
+  {
+    size_t lb = 0, ub = 0;
+    while (lb < n && arr[lb] < key)
+      lb++;
+    ub = lb;
+    while (ub < n && arr[ub] <= key)
+      ub++;
+
+    node_t *p = rbtree_lower_bound(t, key);
+    assert(lb == n ? p == NULL : p != NULL && p->key == arr[lb]);
+    node_t *q = rbtree_upper_bound(t, key);
+    assert(ub == n ? q == NULL : q != NULL && q->key == arr[ub]);
+
+    // [key, key + 10) 범위, cap으로 잘리는 경우 포함
+    size_t hi = lb;
+    while (hi < n && arr[hi] < key + 10)
+      hi++;
+    size_t cnt = rbtree_range(t, key, key + 10, res, n);
+    assert(cnt == hi - lb);
+    for (size_t i = 0; i < cnt; i++)
+    {
+      assert(res[i] == arr[lb + i]);
+    }
+    if (hi - lb > 1)
+    {
+      assert(rbtree_range(t, key, key + 10, res, 1) == 1);
+      assert(res[0] == arr[lb]);
+    }
+  }
+  assert(rbtree_range(t, 10, 5, res, n) == 0);
+
+  free(res);
+  free(arr);
+  delete_rbtree(t);
+}
+
+// find_batch는 키마다 rbtree_find와 같은 노드를 돌려줘야 함
+void test_find_batch(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  const size_t m = n * 3;
+  key_t *keys = calloc(m, sizeof(key_t));
+  node_t **out = calloc(m, sizeof(node_t *));
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_insert(t, rand() % n); // 중복 키 포함
+  }
+  for (size_t i = 0; i < m; i++)
+  {
+    keys[i] = rand() % (n * 2) - 1; // 없는 키 포함
+  }
+
+  // 동시에 진행하는 탐색 수보다 작거나 큰 배치 모두
+  const size_t sizes[] = {0, 1, 15, 16, 17, m};
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++)
+  {
+    memset(out, 0xff, m * sizeof(node_t *));
+    size_t found = 0;
+    for (size_t i = 0; i < sizes[k]; i++)
+    {
+      found += rbtree_find(t, keys[i]) != NULL;
+    }
+    assert(rbtree_find_batch(t, keys, sizes[k], out) == found);
+    for (size_t i = 0; i < sizes[k]; i++)
+    {
+      assert(out[i] == rbtree_find(t, keys[i]));
+    }
+  }
+
+  // 빈 트리에서는 모두 NULL
+  rbtree *e = new_rbtree();
+  assert(rbtree_find_batch(e, keys, m, out) == 0);
+  for (size_t i = 0; i < m; i++)
+  {
+    assert(out[i] == NULL);
+  }
+  delete_rbtree(e);
+
+  free(out);
+  free(keys);
+  delete_rbtree(t);
+}
+
+// 스냅샷의 탐색 결과는 정렬된 배열에서 구한 결과와 같아야 함 (층이 1개부터 4개까지)
+void test_frozen(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n + 2, sizeof(key_t));
+  key_t *res = calloc(n + 2, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n + 1) - (key_t)n / 2; // 중복, 음수 키 포함
+  }
+  if (n > 2) // 키 범위의 양 끝 값도 포함
+  {
+    arr[0] = INT_MIN;
+    arr[1] = INT_MAX;
+  }
+  insert_arr(t, arr, n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  frozen_rbtree *f = rbtree_freeze(t);
+  assert(f != NULL);
+  assert(f->n == n);
+  delete_rbtree(t); // 스냅샷은 원래 트리와 독립
+
+  const key_t probes[] = {INT_MIN, INT_MAX, INT_MAX - 1, 0, 1, -1};
+  for (size_t p = 0; p < sizeof(probes) / sizeof(probes[0]) + n + 2; p++)
+  {
+    key_t key = p < sizeof(probes) / sizeof(probes[0]) ? probes[p] : (key_t)(p - sizeof(probes) / sizeof(probes[0])) - (key_t)n / 2 - 1;
+    size_t lb = 0, ub = 0;
+    while (lb < n && arr[lb] < key)
+      lb++;
+    ub = lb;
+    while (ub < n && arr[ub] <= key)
+      ub++;
+
+    assert(frozen_rbtree_lower_bound(f, key) == lb);
+    assert(frozen_rbtree_upper_bound(f, key) == ub);
+    assert(frozen_rbtree_find(f, key) == (lb < ub ? lb : FROZEN_RBTREE_NPOS));
+    if (key <= INT_MAX - 3)
+    {
+      size_t hi = lb;
+      while (hi < n && arr[hi] < key + 3)
+        hi++;
+      assert(frozen_rbtree_range(f, key, key + 3, res, n + 2) == hi - lb);
+      for (size_t i = lb; i < hi; i++)
+      {
+        assert(res[i - lb] == arr[i]);
+      }
+    }
+  }
+
+  delete_frozen_rbtree(f);
+  free(res);
+  free(arr);
+}
+
+void test_frozen_suite()
+{
+  test_frozen(0, 79);
+  test_frozen(1, 79);
+  test_frozen(16, 79);
+  test_frozen(17, 79);
+  test_frozen(300, 83);
+  test_frozen(5000, 89);
+}
+
 void test_multi_instance()
 {
   rbtree *t1 = new_rbtree();
@@ -271,13 +596,13 @@ static bool color_traverse(const node_t *p, const color_t parent_color, const in
     }
     return true;
   }
-  if (parent_color == RBTREE_RED && p->color == RBTREE_RED)
+  if (parent_color == RBTREE_RED && rbtree_color(p) == RBTREE_RED)
   {
     return false;
   }
-  int next_depth = ((p->color == RBTREE_BLACK) ? 1 : 0) + black_depth;
-  return color_traverse(p->left, p->color, next_depth, nil) &&
-         color_traverse(p->right, p->color, next_depth, nil);
+  int next_depth = ((rbtree_color(p) == RBTREE_BLACK) ? 1 : 0) + black_depth;
+  return color_traverse(p->left, rbtree_color(p), next_depth, nil) &&
+         color_traverse(p->right, rbtree_color(p), next_depth, nil);
 }
 
 void test_color_constraint(const rbtree *t)
@@ -289,7 +614,7 @@ void test_color_constraint(const rbtree *t)
   node_t *nil = NULL;
 #endif
   node_t *p = t->root;
-  assert(p == nil || p->color == RBTREE_BLACK);
+  assert(p == nil || rbtree_color(p) == RBTREE_BLACK);
 
   init_color_traverse();
   assert(color_traverse(p, RBTREE_BLACK, 0, nil));
@@ -410,18 +735,1363 @@ void test_find_erase_rand(const size_t n, const unsigned int seed)
   delete_rbtree(t);
 }
 
-int main(void)
+// hint 삽입은 hint 위치와 상관없이 일반 삽입과 같은 결과를 내야 함
+void test_insert_hint(const size_t n, const unsigned int seed)
 {
-  test_init();
-  test_insert_single(1024);
-  test_find_single(512, 1024);
-  test_erase_root(128);
-  test_find_erase_fixed();
-  test_minmax_suite();
-  test_to_array_suite();
-  test_distinct_values();
-  test_duplicate_values();
-  test_multi_instance();
-  test_find_erase_rand(10000, 17);
+  srand(seed);
+  key_t *arr = calloc(n, sizeof(key_t));
+  key_t *res = calloc(n, sizeof(key_t));
+
+  for (int pattern = 0; pattern < 4; pattern++)
+  {
+    rbtree *t = new_rbtree();
+    node_t *hint = NULL;
+    for (size_t i = 0; i < n; i++)
+    {
+      switch (pattern)
+      {
+      case 0: // 오름차순, hint는 직전 노드
+        arr[i] = (key_t)i;
+        break;
+      case 1: // 내림차순, hint는 직전 노드
+        arr[i] = (key_t)(n - i);
+        break;
+      case 2: // 거의 정렬됨 (가끔 뒤로 튀는 키, 중복 포함)
+        arr[i] = (key_t)(i / 2) - (rand() % 8 == 0 ? rand() % 16 : 0);
+        break;
+      default: // 무작위 키, 무작위 hint
+        arr[i] = rand() % n;
+        if (i > 0)
+          hint = rbtree_find(t, arr[rand() % i]);
+        break;
+      }
+      hint = rbtree_insert_hint(t, hint, arr[i]);
+      assert(hint != NULL && hint->key == arr[i]);
+    }
+    test_color_constraint(t);
+    test_search_constraint(t);
+    check_minmax_cache(t);
+
+    qsort((void *)arr, n, sizeof(key_t), comp);
+    rbtree_to_array(t, res, n);
+    for (size_t i = 0; i < n; i++)
+    {
+      assert(arr[i] == res[i]);
+    }
+    delete_rbtree(t);
+  }
+
+  free(res);
+  free(arr);
+}
+
+// 배치 삽입은 작은 배치(finger 삽입)와 큰 배치(재구성) 모두 하나씩 삽입한 것과 같은 결과를 내야 함
+void test_insert_batch(const size_t n, const size_t m, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(n + m + 1, sizeof(key_t));
+  key_t *res = calloc(n + m + 1, sizeof(key_t));
+  rbtree *t = new_rbtree();
+
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n + m + 1) - (key_t)m; // 음수와 중복 키 포함
+    rbtree_insert(t, arr[i]);
+  }
+  for (size_t i = n; i < n + m; i++)
+  {
+    arr[i] = rand() % (n + m + 1) - (key_t)m;
+  }
+
+  node_t *probe = n > 0 ? rbtree_find(t, arr[0]) : NULL; // 기존 노드는 재구성해도 주소와 키가 그대로여야 함
+  assert(rbtree_insert_batch(t, arr + n, m) == 0);
+  assert(t->count == n + m);
+  assert(probe == NULL || probe->key == arr[0]);
+  test_color_constraint(t);
+  test_search_constraint(t);
+  check_minmax_cache(t);
+
+  qsort((void *)arr, n + m, sizeof(key_t), comp);
+  rbtree_to_array(t, res, n + m);
+  for (size_t i = 0; i < n + m; i++)
+  {
+    assert(arr[i] == res[i]);
+  }
+#ifdef RBTREE_ORDER_STAT
+  for (size_t i = 0; i < n + m; i += 7)
+  {
+    assert(rbtree_select(t, i)->key == arr[i]);
+  }
+#endif
+
+  // 배치로 넣은 트리도 일반 트리처럼 수정 가능해야 함
+  for (size_t i = 0; i < n + m; i += 3)
+  {
+    rbtree_erase(t, rbtree_find(t, arr[i]));
+  }
+  test_color_constraint(t);
+  test_search_constraint(t);
+
+  free(res);
+  free(arr);
+  delete_rbtree(t);
+}
+
+// 재구성 경로에서도 rbtree_insert_node로 넣은 노드는 그대로 트리에 남아 떼어낼 수 있어야 함
+void test_insert_batch_intrusive()
+{
+  rbtree *t = new_rbtree();
+  node_t own;
+  own.key = 11;
+  assert(rbtree_insert_node(t, &own) == &own);
+
+  key_t keys[100];
+  for (size_t i = 0; i < 100; i++)
+    keys[i] = (key_t)(2 * (100 - i)); // 짝수만 넣어서 own과 합쳐지지 않게 함
+  assert(rbtree_insert_batch(t, keys, 100) == 0); // 트리 크기보다 큰 배치 -> 재구성
+  assert(own.key == 11);
+  assert(rbtree_find(t, 11) == &own);
+  assert(rbtree_size(t) == 101);
+  test_color_constraint(t);
+  test_search_constraint(t);
+  check_minmax_cache(t);
+
+  rbtree_remove_node(t, &own);
+  assert(rbtree_find(t, 11) == NULL);
+  assert(rbtree_size(t) == 100);
+  delete_rbtree(t);
+}
+
+void test_insert_batch_suite()
+{
+  test_insert_batch(0, 0, 37);
+  test_insert_batch(0, 100, 37);  // 빈 트리 -> 재구성
+  test_insert_batch(1000, 10, 37);  // 작은 배치 -> finger 삽입
+  test_insert_batch(1000, 200, 41); // finger 삽입 + 기수 정렬
+  test_insert_batch(1000, 5000, 43); // 재구성
+  test_insert_batch_intrusive();
+}
+
+// 정렬된 배열로 만든 트리는 RB 제약을 만족하고 배열과 같은 순서를 가져야 함
+void test_from_sorted(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(n + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n + 1); // 중복 키 포함
+  }
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  rbtree *t = rbtree_from_sorted(arr, n);
+  assert(t != NULL);
+  check_minmax_cache(t);
+  test_color_constraint(t);
+  test_search_constraint(t);
+
+  key_t *res = calloc(n + 1, sizeof(key_t));
+  rbtree_to_array(t, res, n);
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(arr[i] == res[i]);
+  }
+
+  // 생성된 트리도 일반 트리처럼 수정 가능해야 함
+  for (size_t i = 0; i < n; i += 2)
+  {
+    node_t *p = rbtree_find(t, arr[i]);
+    assert(p != NULL);
+    rbtree_erase(t, p);
+  }
+  rbtree_insert(t, -1);
+  test_color_constraint(t);
+  test_search_constraint(t);
+
+  free(res);
+  free(arr);
+  delete_rbtree(t);
+}
+
+void test_from_sorted_suite()
+{
+  for (size_t n = 0; n <= 64; n++)
+  {
+    test_from_sorted(n, 7);
+  }
+  test_from_sorted(10000, 17);
+}
+
+#ifdef RBTREE_ORDER_STAT
+// 모든 노드의 size는 왼쪽 + 오른쪽 서브트리 크기 + 노드의 키 수(multiset이 아니면 1)여야 함
+static size_t size_traverse(const node_t *p, const node_t *nil)
+{
+  if (p == nil)
+  {
+    return 0;
+  }
+  size_t size = size_traverse(p->left, nil) + size_traverse(p->right, nil) + rbtree_weight(p);
+  assert(p->size == size);
+  return size;
+}
+
+// select, rank, count_range는 정렬된 배열에서 구한 결과와 같아야 함
+void test_order_stat(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+  }
+  insert_arr(t, arr, n);
+
+  // 절반을 지워서 erase 경로의 size 갱신도 확인
+  for (size_t i = 0; i < n / 2; i++)
+  {
+    rbtree_erase(t, rbtree_find(t, arr[i]));
+  }
+  const size_t m = n - n / 2;
+  key_t *rest = arr + n / 2;
+  qsort((void *)rest, m, sizeof(key_t), comp);
+  assert(size_traverse(t->root, t->nil) == m);
+
+  for (size_t k = 0; k < m; k++)
+  {
+    node_t *p = rbtree_select(t, k);
+    assert(p != NULL);
+    assert(p->key == rest[k]);
+  }
+  assert(rbtree_select(t, m) == NULL);
+
+  for (key_t key = -1; key <= (key_t)n; key++)
+  {
+    size_t rank = 0;
+    while (rank < m && rest[rank] < key)
+      rank++;
+    assert(rbtree_rank(t, key) == rank);
+
+    size_t hi = rank;
+    while (hi < m && rest[hi] < key + 5)
+      hi++;
+    assert(rbtree_count_range(t, key, key + 5) == hi - rank);
+  }
+
+  rbtree *u = rbtree_from_sorted(rest, m);
+  assert(size_traverse(u->root, u->nil) == m);
+  delete_rbtree(u);
+
+  free(arr);
+  delete_rbtree(t);
+}
+#endif
+
+// 트리가 RB 제약을 만족하고 정렬된 배열 arr과 같은 키를 가져야 함
+static void check_tree_keys(rbtree *t, const key_t *arr, const size_t n)
+{
+  test_color_constraint(t);
+  test_search_constraint(t);
+  check_minmax_cache(t);
+  assert(rbtree_size(t) == n);
+#ifdef RBTREE_ORDER_STAT
+  assert(size_traverse(t->root, t->nil) == n);
+#endif
+
+  key_t *res = calloc(n + 1, sizeof(key_t));
+  assert(rbtree_to_array(t, res, n) == 0);
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(arr[i] == res[i]);
+  }
+  free(res);
+}
+
+// split한 두 트리는 기준 키 앞뒤로 나뉘어야 하고, join하면 다시 하나의 트리가 되어야 함
+void test_split_join(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(n + 1, sizeof(key_t));
+  key_t *joined = calloc(n + 2, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+  }
+  const key_t keys[] = {-1, 0, arr[0], arr[n / 2], (key_t)n / 3, (key_t)n};
+
+  for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++)
+  {
+    rbtree *t = new_rbtree();
+    insert_arr(t, arr, n);
+    qsort((void *)arr, n, sizeof(key_t), comp);
+
+    rbtree *lo, *hi;
+    assert(rbtree_split(t, keys[k], &lo, &hi) == 0);
+    assert(lo == t);
+    size_t cut = 0;
+    while (cut < n && arr[cut] < keys[k])
+      cut++;
+    check_tree_keys(lo, arr, cut);
+    check_tree_keys(hi, arr + cut, n - cut);
+
+    // 순서가 맞지 않는 join은 실패하고 두 트리는 그대로
+    if (cut > 0 && cut < n)
+    {
+      assert(rbtree_join(hi, keys[k], lo) == -1);
+      check_tree_keys(lo, arr, cut);
+    }
+
+    assert(rbtree_join(lo, keys[k], hi) == 0);
+    memcpy(joined, arr, cut * sizeof(key_t));
+    joined[cut] = keys[k];
+    memcpy(joined + cut + 1, arr + cut, (n - cut) * sizeof(key_t));
+    check_tree_keys(lo, joined, n + 1);
+    rbtree_insert(lo, keys[k]); // 합친 트리도 일반 트리처럼 수정 가능해야 함
+    rbtree_erase(lo, rbtree_find(lo, keys[k]));
+    check_tree_keys(lo, joined, n + 1);
+    delete_rbtree(lo);
+  }
+
+  // 다른 풀의 트리끼리, 빈 트리와도 join 가능해야 함
+  rbtree *a = rbtree_from_sorted(arr, n / 2);
+  rbtree *b = new_rbtree();
+  insert_arr(b, arr + n / 2, n - n / 2);
+  rbtree *e = new_rbtree();
+  assert(rbtree_join(a, arr[n / 2], b) == 0);
+  assert(rbtree_join(e, -1, a) == 0);
+  memcpy(joined + 1, arr, (n / 2) * sizeof(key_t));
+  joined[0] = -1;
+  joined[n / 2 + 1] = arr[n / 2];
+  memcpy(joined + n / 2 + 2, arr + n / 2, (n - n / 2) * sizeof(key_t));
+  check_tree_keys(e, joined, n + 2);
+  delete_rbtree(e);
+
+  free(joined);
+  free(arr);
+}
+
+// erase_key와 erase_range는 정렬된 배열에서 같은 키를 뺀 결과와 같아야 함
+void test_erase_range(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(n + 1, sizeof(key_t));
+  key_t *rest = calloc(n + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+  }
+  qsort((void *)arr, n, sizeof(key_t), comp);
+  // 빈 범위, 노드 몇 개짜리 범위, 큰 범위, 전체 범위
+  const key_t ranges[][2] = {{5, 5}, {7, 3}, {-10, -1}, {(key_t)n, (key_t)n + 10}, {arr[n / 2], arr[n / 2] + 1},
+                             {10, 13}, {(key_t)n / 4, (key_t)n / 2}, {-1, (key_t)n / 3}, {(key_t)n / 2, (key_t)n + 1}, {-1, (key_t)n + 1}};
+
+  for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+  {
+    const key_t lo = ranges[r][0], hi = ranges[r][1];
+    rbtree *t = new_rbtree();
+    insert_arr(t, arr, n);
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+      if (arr[i] < lo || arr[i] >= hi)
+        rest[m++] = arr[i];
+    }
+    assert(rbtree_erase_range(t, lo, hi) == n - m);
+    check_tree_keys(t, rest, m);
+
+    // 지운 트리도 일반 트리처럼 수정 가능해야 함
+    rbtree_insert(t, lo);
+    assert(rbtree_erase_key(t, lo) == 0);
+    check_tree_keys(t, rest, m);
+    delete_rbtree(t);
+  }
+
+  // erase_key는 같은 키를 하나씩 지우고, 없는 키는 -1
+  rbtree *t = new_rbtree();
+  insert_arr(t, arr, n);
+  assert(rbtree_erase_key(t, -1) == -1);
+  for (size_t i = 0; i < n; i += 2)
+  {
+    assert(rbtree_erase_key(t, arr[i]) == 0);
+  }
+  size_t m = 0;
+  for (size_t i = 1; i < n; i += 2)
+  {
+    rest[m++] = arr[i];
+  }
+  qsort((void *)rest, m, sizeof(key_t), comp);
+  check_tree_keys(t, rest, m);
+  delete_rbtree(t);
+
+  free(rest);
+  free(arr);
+}
+
+// 노드를 옮긴 뒤에도 같은 키, RB 제약, 부모 포인터를 유지하고 계속 수정할 수 있어야 함
+void test_compact(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(2 * n + 1, sizeof(key_t));
+  for (size_t i = 0; i < 2 * n; i++)
+  {
+    arr[i] = rand() % (2 * n); // 중복 키 포함
+  }
+
+  rbtree *t = new_rbtree();
+  rbtree *u = new_rbtree_shared(t); // 풀을 공유하는 트리는 그대로 남아야 함
+  assert(rbtree_compact(t) == 0); // 빈 트리
+  insert_arr(t, arr, 2 * n);
+  insert_arr(u, arr, n);
+  // 앞 절반을 지워서 노드를 흩어 놓음
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(rbtree_erase_key(t, arr[i]) == 0);
+  }
+  key_t *rest = calloc(n + 1, sizeof(key_t));
+  memcpy(rest, arr + n, n * sizeof(key_t));
+  qsort((void *)rest, n, sizeof(key_t), comp);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  assert(rbtree_compact(t) == 0);
+  check_tree_keys(t, rest, n);
+  check_tree_keys(u, arr, n);
+  delete_rbtree(u);
+
+  // 부모 포인터로 끝까지 따라갈 수 있어야 함
+  size_t keys = 0;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p))
+  {
+    keys += rbtree_weight(p);
+  }
+  assert(keys == n);
+
+  // 풀을 혼자 쓰면 노드가 모두 한 연속 영역에 모여야 함
+  assert(rbtree_compact(t) == 0);
+#ifndef RBTREE_NO_POOL
+  node_t *lo = t->root, *hi = t->root;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p))
+  {
+    lo = p < lo ? p : lo;
+    hi = p > hi ? p : hi;
+  }
+  size_t nodes = 0;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p))
+  {
+    nodes++;
+  }
+  assert((size_t)(hi - lo) == nodes - 1);
+#endif
+
+  // 옮긴 뒤에도 일반 트리처럼 삽입 / 삭제 가능해야 함
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_insert(t, arr[i]);
+  }
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(rbtree_erase_key(t, rest[i]) == 0);
+  }
+  check_tree_keys(t, arr, n);
+  delete_rbtree(t);
+
+  free(rest);
+  free(arr);
+}
+
+// 저장한 스냅샷을 다시 읽으면 같은 키의 트리가 되어야 하고, 손상된 파일은 거부해야 함
+void test_snapshot(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  key_t *arr = calloc(n + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n / 2 + 1) - (key_t)(n / 4); // 음수와 중복 키 포함
+  }
+  rbtree *t = new_rbtree();
+  insert_arr(t, arr, n);
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  char path[] = "/tmp/test-rbtree-snapshot-XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  unlink(path);
+
+  assert(rbtree_save(t, fd) == 0);
+  const off_t size = lseek(fd, 0, SEEK_CUR);
+  assert((size_t)size == sizeof(rbtree_snapshot_header) + n * sizeof(key_t) + sizeof(uint64_t));
+  rbtree *u = rbtree_load(fd);
+  assert(u != NULL);
+  check_tree_keys(u, arr, n);
+  // 읽은 트리도 일반 트리처럼 수정 가능해야 함
+  rbtree_insert(u, arr[0]);
+  assert(rbtree_erase_key(u, arr[0]) == 0);
+  check_tree_keys(u, arr, n);
+  delete_rbtree(u);
+
+  // 키 하나가 바뀌면 체크섬이 맞지 않음
+  key_t key;
+  const off_t at = (off_t)(sizeof(rbtree_snapshot_header) + n / 2 * sizeof(key_t));
+  assert(pread(fd, &key, sizeof(key), at) == sizeof(key));
+  key ^= 1;
+  assert(pwrite(fd, &key, sizeof(key), at) == sizeof(key));
+  assert(rbtree_load(fd) == NULL);
+  key ^= 1;
+  assert(pwrite(fd, &key, sizeof(key), at) == sizeof(key));
+  u = rbtree_load(fd);
+  assert(u != NULL);
+  delete_rbtree(u);
+
+  // 바이트 순서가 다른 기계에서 쓴 파일은 거부
+  const off_t order_at = (off_t)offsetof(rbtree_snapshot_header, byte_order);
+  uint32_t order = __builtin_bswap32(RBTREE_SNAPSHOT_BYTE_ORDER);
+  assert(pwrite(fd, &order, sizeof(order), order_at) == sizeof(order));
+  assert(rbtree_load(fd) == NULL);
+  order = RBTREE_SNAPSHOT_BYTE_ORDER;
+  assert(pwrite(fd, &order, sizeof(order), order_at) == sizeof(order));
+
+  // 버전이 다르거나 잘린 파일은 거부
+  uint32_t version = RBTREE_SNAPSHOT_VERSION + 1;
+  assert(pwrite(fd, &version, sizeof(version), 8) == sizeof(version));
+  assert(rbtree_load(fd) == NULL);
+  version = RBTREE_SNAPSHOT_VERSION;
+  assert(pwrite(fd, &version, sizeof(version), 8) == sizeof(version));
+  assert(ftruncate(fd, size - 1) == 0);
+  assert(rbtree_load(fd) == NULL);
+
+  // 빈 트리
+  assert(ftruncate(fd, 0) == 0);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+  rbtree *e = new_rbtree();
+  assert(rbtree_save(e, fd) == 0);
+  u = rbtree_load(fd);
+  assert(u != NULL);
+  check_tree_keys(u, arr, 0);
+  delete_rbtree(u);
+  delete_rbtree(e);
+
+  close(fd);
+  delete_rbtree(t);
+  free(arr);
+}
+
+// 정렬한 뒤 중복을 없앤 배열의 크기를 반환
+static size_t sort_unique(key_t *arr, const size_t n)
+{
+  qsort((void *)arr, n, sizeof(key_t), comp);
+  size_t m = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    if (m == 0 || arr[m - 1] != arr[i])
+      arr[m++] = arr[i];
+  }
+  return m;
+}
+
+// 합집합 / 교집합 / 차집합은 정렬된 배열을 병합한 결과와 같아야 함
+void test_set_ops(const size_t n, const size_t m, const int shared, const unsigned int seed)
+{
+  srand(seed);
+  const key_t range = (key_t)(n + m) * 2;
+  key_t *a = calloc(n + 1, sizeof(key_t));
+  key_t *b = calloc(m + 1, sizeof(key_t));
+  key_t *expect = calloc(n + m + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+    a[i] = rand() % range;
+  for (size_t i = 0; i < m; i++)
+    b[i] = rand() % range;
+  const size_t na = sort_unique(a, n);
+  const size_t nb = sort_unique(b, m);
+
+  for (int op = 0; op < 3; op++)
+  {
+    rbtree *t1 = new_rbtree();
+    rbtree *t2 = shared ? new_rbtree_shared(t1) : new_rbtree();
+    insert_arr(t1, a, na);
+    insert_arr(t2, b, nb);
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < na || j < nb)
+    {
+      if (j == nb || (i < na && a[i] < b[j])) // a에만 있음
+      {
+        if (op != 1)
+          expect[k++] = a[i];
+        i++;
+      }
+      else if (i == na || b[j] < a[i]) // b에만 있음
+      {
+        if (op == 0)
+          expect[k++] = b[j];
+        j++;
+      }
+      else // 양쪽에 있음
+      {
+        if (op != 2)
+          expect[k++] = a[i];
+        i++;
+        j++;
+      }
+    }
+
+    if (op == 0)
+      assert(rbtree_union(t1, t2) == 0);
+    else if (op == 1)
+      assert(rbtree_intersection(t1, t2) == 0);
+    else
+      assert(rbtree_difference(t1, t2) == 0);
+    check_tree_keys(t1, expect, k);
+    delete_rbtree(t1);
+  }
+
+  free(expect);
+  free(b);
+  free(a);
+}
+
+// 중복 키가 있으면 기본 빌드는 키 단위, RBTREE_MULTISET은 개수 단위로 계산해야 함 (a, b는 정렬된 배열)
+void test_set_ops_dups(const key_t *a, const size_t na, const key_t *b, const size_t nb)
+{
+  key_t *expect = calloc(na + nb + 1, sizeof(key_t));
+
+  for (int op = 0; op < 3; op++)
+  {
+    rbtree *t1 = new_rbtree();
+    rbtree *t2 = new_rbtree_shared(t1);
+    insert_arr(t1, a, na);
+    insert_arr(t2, b, nb);
+
+    size_t i = 0, j = 0, k = 0;
+    while (i < na || j < nb)
+    {
+      // 가장 작은 키 하나의 개수를 양쪽에서 셈
+      const key_t key = j == nb || (i < na && a[i] < b[j]) ? a[i] : b[j];
+      size_t ca = 0, cb = 0, c;
+      for (; i < na && a[i] == key; i++)
+        ca++;
+      for (; j < nb && b[j] == key; j++)
+        cb++;
+#ifdef RBTREE_MULTISET
+      if (op == 0)
+        c = ca > cb ? ca : cb;
+      else if (op == 1)
+        c = ca < cb ? ca : cb;
+      else
+        c = ca > cb ? ca - cb : 0;
+#else
+      if (op == 0)
+        c = ca > 0 ? ca : cb;
+      else if (op == 1)
+        c = cb > 0 ? ca : 0;
+      else
+        c = cb > 0 ? 0 : ca;
+#endif
+      while (c-- > 0)
+        expect[k++] = key;
+    }
+
+    if (op == 0)
+      assert(rbtree_union(t1, t2) == 0);
+    else if (op == 1)
+      assert(rbtree_intersection(t1, t2) == 0);
+    else
+      assert(rbtree_difference(t1, t2) == 0);
+    check_tree_keys(t1, expect, k);
+    delete_rbtree(t1);
+  }
+
+  free(expect);
+}
+
+// 좁은 범위의 무작위 키로 중복이 트리 곳곳에 퍼지게 만들어서 확인
+void test_set_ops_dups_random(const size_t n, const size_t m, const key_t range, const unsigned int seed)
+{
+  srand(seed);
+  key_t *a = calloc(n + 1, sizeof(key_t));
+  key_t *b = calloc(m + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+    a[i] = rand() % range;
+  for (size_t i = 0; i < m; i++)
+    b[i] = rand() % range;
+  qsort((void *)a, n, sizeof(key_t), comp);
+  qsort((void *)b, m, sizeof(key_t), comp);
+  test_set_ops_dups(a, n, b, m);
+  free(b);
+  free(a);
+}
+
+void test_set_ops_suite()
+{
+  test_set_ops(0, 0, 1, 47);
+  test_set_ops(100, 0, 0, 47);
+  test_set_ops(0, 100, 1, 47);
+  test_set_ops(1000, 1000, 1, 53);
+  test_set_ops(1000, 1000, 0, 53);
+  test_set_ops(5000, 30, 1, 59);
+  test_set_ops(30, 5000, 0, 59);
+
+  const key_t three[] = {5, 5, 5}, two[] = {5, 5};
+  test_set_ops_dups(three, 3, two, 2);
+  test_set_ops_dups(two, 2, three, 3);
+  const key_t a[] = {1, 5, 5, 5, 7, 7}, b[] = {5, 5, 7, 9, 9};
+  test_set_ops_dups(a, 6, b, 5);
+  test_set_ops_dups_random(2000, 2000, 50, 61);
+  test_set_ops_dups_random(3000, 100, 300, 67);
+  test_set_ops_dups_random(100, 3000, 30, 71);
+}
+
+// 병렬 버전은 순차 버전과 같은 결과를 내야 함
+void test_parallel(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree_workers *w = rbtree_workers_new(4);
+  assert(w != NULL);
+  assert(rbtree_workers_count(w) == 4);
+
+  key_t *arr = calloc(n + 1, sizeof(key_t));
+  key_t *res = calloc(n + 1, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (n * 2); // 중복 키 포함
+  }
+  qsort((void *)arr, n, sizeof(key_t), comp);
+
+  rbtree *t = rbtree_from_sorted_par(w, arr, n);
+  assert(t != NULL);
+  check_tree_keys(t, arr, n);
+
+  assert(rbtree_to_array_par(w, t, res, n) == 0);
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(arr[i] == res[i]);
+  }
+  // 배열이 작으면 앞쪽 키만 채워야 함
+  memset(res, 0, (n + 1) * sizeof(key_t));
+  res[n / 3] = -7;
+  assert(rbtree_to_array_par(w, t, res, n / 3) == 0);
+  for (size_t i = 0; i < n / 3; i++)
+  {
+    assert(arr[i] == res[i]);
+  }
+  assert(res[n / 3] == -7);
+  delete_rbtree(t);
+
+  // 집합 연산은 같은 입력의 순차 버전 결과와 비교
+  for (int op = 0; op < 3; op++)
+  {
+    rbtree *a = rbtree_from_sorted(arr, n);
+    rbtree *b = new_rbtree_shared(a);
+    rbtree *c = rbtree_from_sorted(arr, n);
+    rbtree *d = new_rbtree_shared(c);
+    for (size_t i = 0; i < n / 2; i++)
+    {
+      key_t key = rand() % (n * 2);
+      rbtree_insert(b, key);
+      rbtree_insert(d, key);
+    }
+
+    if (op == 0)
+    {
+      assert(rbtree_union_par(w, a, b) == 0);
+      assert(rbtree_union(c, d) == 0);
+    }
+    else if (op == 1)
+    {
+      assert(rbtree_intersection_par(w, a, b) == 0);
+      assert(rbtree_intersection(c, d) == 0);
+    }
+    else
+    {
+      assert(rbtree_difference_par(w, a, b) == 0);
+      assert(rbtree_difference(c, d) == 0);
+    }
+
+    const size_t m = rbtree_size(c);
+    key_t *expect = calloc(m + 1, sizeof(key_t));
+    rbtree_to_array(c, expect, m);
+    check_tree_keys(a, expect, m);
+    free(expect);
+    delete_rbtree(a);
+    delete_rbtree(c);
+  }
+
+  free(res);
+  free(arr);
+  rbtree_workers_delete(w);
+}
+
+#ifdef RBTREE_MULTISET
+#define MULTISET_RANGE 50
+
+// 키별 개수 배열을 정렬된 키 배열로 펼침
+static size_t expand_counts(const unsigned int *cnt, key_t *out)
+{
+  size_t k = 0;
+  for (key_t key = 0; key < MULTISET_RANGE; key++)
+  {
+    for (unsigned int c = 0; c < cnt[key]; c++)
+      out[k++] = key;
+  }
+  return k;
+}
+
+// 같은 키는 노드 하나에 개수로 합쳐지고, 개수를 펼친 결과는 중복을 허용하는 트리와 같아야 함
+void test_multiset(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  unsigned int cnt[MULTISET_RANGE] = {0}, cnt2[MULTISET_RANGE] = {0}, res[MULTISET_RANGE];
+  key_t *arr = calloc(n * 2 + 2, sizeof(key_t));
+  key_t *expect = calloc(n * 2 + 2, sizeof(key_t));
+  rbtree *t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % MULTISET_RANGE;
+    cnt[arr[i]]++;
+    node_t *p = rbtree_insert(t, arr[i]);
+    assert(p->key == arr[i] && p->count == cnt[arr[i]]);
+  }
+  size_t m = expand_counts(cnt, expect);
+  check_tree_keys(t, expect, m);
+
+  // 노드는 서로 다른 키 하나씩만 있어야 함
+  size_t nodes = 0;
+  for (node_t *p = rbtree_min(t); p != NULL; p = rbtree_next(t, p), nodes++)
+  {
+    assert(p->count == cnt[p->key]);
+  }
+  for (key_t key = 0; key < MULTISET_RANGE; key++)
+  {
+    nodes -= cnt[key] > 0;
+  }
+  assert(nodes == 0);
+
+  // hint 삽입도 같은 키의 개수만 늘림
+  assert(rbtree_insert_hint(t, rbtree_max(t), rbtree_max(t)->key) == rbtree_max(t));
+  cnt[rbtree_max(t)->key]++;
+  assert(rbtree_insert_hint(t, rbtree_min(t), 0) == rbtree_find(t, 0));
+  cnt[0]++;
+
+  // erase는 개수를 하나씩 줄이고 마지막 하나일 때 노드를 삭제
+  for (size_t i = 0; i < n / 2; i++)
+  {
+    node_t *p = rbtree_find(t, arr[i]);
+    assert(p != NULL);
+    rbtree_erase(t, p);
+    cnt[arr[i]]--;
+    assert(cnt[arr[i]] > 0 ? rbtree_find(t, arr[i]) == p : rbtree_find(t, arr[i]) == NULL);
+  }
+  m = expand_counts(cnt, expect);
+  check_tree_keys(t, expect, m);
+
+  // 배치 삽입 (finger 삽입과 재구성 모두)과 정렬된 배열로 만든 트리도 같은 키를 합침
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % MULTISET_RANGE;
+    cnt[arr[i]]++;
+  }
+  assert(rbtree_insert_batch(t, arr, 3) == 0);
+  assert(rbtree_insert_batch(t, arr + 3, n - 3) == 0);
+  m = expand_counts(cnt, expect);
+  check_tree_keys(t, expect, m);
+  rbtree *u = rbtree_from_sorted(expect, m);
+  check_tree_keys(u, expect, m);
+  for (node_t *p = rbtree_min(u); p != NULL; p = rbtree_next(u, p))
+  {
+    assert(p->count == cnt[p->key]);
+  }
+
+  // 같은 키로 split한 뒤 그 키로 join하면 끝 노드에 개수가 합쳐짐
+  rbtree *lo, *hi;
+  assert(rbtree_split(u, MULTISET_RANGE / 2, &lo, &hi) == 0);
+  assert(rbtree_join(lo, MULTISET_RANGE / 2, hi) == 0);
+  cnt[MULTISET_RANGE / 2]++;
+  m = expand_counts(cnt, expect);
+  check_tree_keys(lo, expect, m);
+  delete_rbtree(lo);
+
+  // 집합 연산: 합집합은 큰 개수, 교집합은 작은 개수, 차집합은 개수를 뺌
+  for (int op = 0; op < 3; op++)
+  {
+    rbtree *t1 = new_rbtree();
+    rbtree *t2 = new_rbtree_shared(t1);
+    for (key_t key = 0; key < MULTISET_RANGE; key++)
+    {
+      cnt[key] = rand() % 4;
+      cnt2[key] = rand() % 4;
+      for (unsigned int c = 0; c < cnt[key]; c++)
+        rbtree_insert(t1, key);
+      for (unsigned int c = 0; c < cnt2[key]; c++)
+        rbtree_insert(t2, key);
+      if (op == 0)
+        res[key] = cnt[key] > cnt2[key] ? cnt[key] : cnt2[key];
+      else if (op == 1)
+        res[key] = cnt[key] < cnt2[key] ? cnt[key] : cnt2[key];
+      else
+        res[key] = cnt[key] > cnt2[key] ? cnt[key] - cnt2[key] : 0;
+    }
+
+    if (op == 0)
+      assert(rbtree_union(t1, t2) == 0);
+    else if (op == 1)
+      assert(rbtree_intersection(t1, t2) == 0);
+    else
+      assert(rbtree_difference(t1, t2) == 0);
+    m = expand_counts(res, expect);
+    check_tree_keys(t1, expect, m);
+    delete_rbtree(t1);
+  }
+
+  delete_rbtree(t);
+  free(expect);
+  free(arr);
+}
+#endif
+
+struct record {
+  int id;
+  node_t link; // 트리 연결용 노드를 구조체 안에 둠
+  int payload;
+};
+
+// 사용자 구조체에 내장한 노드로 삽입/탐색/삭제 (트리 안에서 할당하지 않음)
+void test_intrusive(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  struct record *recs = calloc(n, sizeof(struct record));
+  for (size_t i = 0; i < n; i++)
+  {
+    recs[i].id = (int)i;
+    recs[i].payload = rand() % 1000;
+    recs[i].link.key = recs[i].payload;
+    assert(rbtree_insert_node(t, &recs[i].link) == &recs[i].link);
+  }
+  test_color_constraint(t);
+  test_search_constraint(t);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    node_t *p = rbtree_find(t, recs[i].payload);
+    assert(p != NULL);
+    struct record *r = rbtree_entry(p, struct record, link);
+    assert(r->payload == recs[i].payload);
+  }
+
+  // 절반을 떼어내도 레코드 메모리는 그대로 남아 있어야 함
+  for (size_t i = 0; i < n; i += 2)
+  {
+    rbtree_remove_node(t, &recs[i].link);
+    assert(recs[i].id == (int)i);
+  }
+  test_color_constraint(t);
+  test_search_constraint(t);
+  check_minmax_cache(t);
+  for (size_t i = 1; i < n; i += 2)
+  {
+    rbtree_remove_node(t, &recs[i].link);
+  }
+  assert(t->root == t->nil);
+  delete_rbtree(t);
+
+  // 호출자가 직접 위치를 찾아 연결하는 방식: 내림차순 트리
+  t = new_rbtree();
+  for (size_t i = 0; i < n; i++)
+  {
+    node_t *parent = t->nil;
+    node_t **link = &t->root;
+    while (*link != t->nil)
+    {
+      parent = *link;
+      link = recs[i].link.key > parent->key ? &parent->left : &parent->right;
+    }
+    rbtree_link_node(t, &recs[i].link, parent, link);
+    rbtree_insert_fixup(t, &recs[i].link);
+  }
+  test_color_constraint(t);
+  size_t cnt = 0;
+  for (node_t *p = rbtree_min(t), *q; p != NULL; p = q, cnt++)
+  {
+    q = rbtree_next(t, p);
+    assert(q == NULL || p->key >= q->key);
+  }
+  assert(cnt == n);
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_remove_node(t, &recs[i].link);
+  }
+  delete_rbtree(t);
+  free(recs);
+}
+
+static inline int cmp_int(int a, int b)
+{
+  return (a > b) - (a < b);
+}
+
+RBTREE_DEFINE(intmap, int, int, cmp_int)
+
+// intmap 서브트리의 black height를 반환, 색상 제약을 어기면 -1
+static int intmap_black_height(const intmap *t, const intmap_node *p)
+{
+  if (p == t->nil)
+  {
+    return 0;
+  }
+  if (p->color == RBTREE_RED && (p->left->color == RBTREE_RED || p->right->color == RBTREE_RED))
+  {
+    return -1;
+  }
+  int l = intmap_black_height(t, p->left);
+  int r = intmap_black_height(t, p->right);
+  if (l < 0 || l != r)
+  {
+    return -1;
+  }
+  return l + (p->color == RBTREE_BLACK ? 1 : 0);
+}
+
+// 매크로로 생성한 트리도 기본 트리와 같은 순서, 탐색, 삭제 동작을 해야 함
+void test_template(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  intmap *t = intmap_new();
+  assert(t != NULL);
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+    intmap_node *p = intmap_insert(t, arr[i], -arr[i]);
+    assert(p != NULL && p->key == arr[i] && p->value == -arr[i]);
+  }
+  assert(intmap_black_height(t, t->root) >= 0);
+
+  for (size_t i = 0; i < n; i += 2)
+  {
+    intmap_node *p = intmap_find(t, arr[i]);
+    assert(p != NULL && p->value == -arr[i]);
+    intmap_erase(t, p);
+  }
+  assert(intmap_black_height(t, t->root) >= 0);
+
+  // 남은 키는 정렬된 순서로 순회되어야 함
+  size_t m = 0;
+  for (size_t i = 1; i < n; i += 2)
+  {
+    arr[m++] = arr[i];
+  }
+  qsort((void *)arr, m, sizeof(key_t), comp);
+  intmap_node *p = intmap_min(t);
+  for (size_t i = 0; i < m; i++, p = intmap_next(t, p))
+  {
+    assert(p != NULL && p->key == arr[i]);
+  }
+  assert(p == NULL);
+  assert(intmap_max(t)->key == arr[m - 1]);
+  assert(intmap_lower_bound(t, arr[m / 2])->key == arr[m / 2]);
+
+  free(arr);
+  intmap_delete(t);
+}
+
+// idx 트리 서브트리의 black height를 반환, 색상 제약을 어기면 -1
+static int idx_black_height(const idx_node_t *n, uint32_t i)
+{
+  if (i == IDX_RBTREE_NIL)
+  {
+    return 0;
+  }
+  color_t color = (color_t)(n[i].parent_color & 1);
+  color_t lc = (color_t)(n[n[i].left].parent_color & 1);
+  color_t rc = (color_t)(n[n[i].right].parent_color & 1);
+  if (color == RBTREE_RED && (lc == RBTREE_RED || rc == RBTREE_RED))
+  {
+    return -1;
+  }
+  int l = idx_black_height(n, n[i].left);
+  int r = idx_black_height(n, n[i].right);
+  if (l < 0 || l != r)
+  {
+    return -1;
+  }
+  return l + (color == RBTREE_BLACK ? 1 : 0);
+}
+
+// 인덱스 기반 트리도 같은 삽입/탐색/삭제 결과를 내고, 이미지를 복사해도 그대로 동작해야 함
+void test_idx_tree(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  idx_rbtree *t = new_idx_rbtree();
+  assert(t != NULL);
+  assert(sizeof(idx_node_t) == 16);
+  assert(idx_rbtree_min(t) == IDX_RBTREE_NIL);
+
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % n; // 중복 키 포함
+    uint32_t p = idx_rbtree_insert(t, arr[i]);
+    assert(p != IDX_RBTREE_NIL);
+    assert(t->img->nodes[p].key == arr[i]);
+  }
+  assert(idx_black_height(t->img->nodes, t->img->root) >= 0);
+
+  for (size_t i = 0; i < n; i += 2)
+  {
+    uint32_t p = idx_rbtree_find(t, arr[i]);
+    assert(p != IDX_RBTREE_NIL);
+    idx_rbtree_erase(t, p);
+  }
+  assert(idx_black_height(t->img->nodes, t->img->root) >= 0);
+
+  size_t m = 0;
+  for (size_t i = 1; i < n; i += 2)
+  {
+    arr[m++] = arr[i];
+  }
+  qsort((void *)arr, m, sizeof(key_t), comp);
+
+  // 이미지를 memcpy로 복사한 트리도 같은 내용을 가져야 함
+  idx_rbtree *u = idx_rbtree_from_image(t->img);
+  assert(u != NULL);
+  delete_idx_rbtree(t);
+
+  key_t *res = calloc(n, sizeof(key_t));
+  idx_rbtree_to_array(u, res, m);
+  for (size_t i = 0; i < m; i++)
+  {
+    assert(res[i] == arr[i]);
+  }
+  assert(u->img->nodes[idx_rbtree_min(u)].key == arr[0]);
+  assert(u->img->nodes[idx_rbtree_max(u)].key == arr[m - 1]);
+
+  // erase한 슬롯은 재사용되어 배열이 더 커지지 않아야 함
+  uint32_t used = u->img->used;
+  for (size_t i = 0; i < n - m; i++)
+  {
+    idx_rbtree_insert(u, (key_t)i);
+  }
+  assert(u->img->used == used);
+  assert(idx_black_height(u->img->nodes, u->img->root) >= 0);
+
+  free(res);
+  free(arr);
+  delete_idx_rbtree(u);
+}
+
+// 파일에 매핑된 트리는 닫았다 다시 열어도 그대로 탐색할 수 있어야 하고, 읽기 전용이면 수정을 거부해야 함
+void test_idx_file(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  char path[] = "/tmp/test-rbtree-idx-XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+
+  idx_rbtree *t = idx_rbtree_open(path, 0); // 빈 파일이면 새 트리
+  assert(t != NULL);
+  key_t *arr = calloc(n, sizeof(key_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    arr[i] = rand() % (key_t)n;
+    assert(idx_rbtree_insert(t, arr[i]) != IDX_RBTREE_NIL); // 파일이 여러 번 늘어남
+  }
+  for (size_t i = 0; i < n; i += 2)
+  {
+    assert(idx_rbtree_erase(t, idx_rbtree_find(t, arr[i])) == 0);
+  }
+  size_t m = 0;
+  for (size_t i = 1; i < n; i += 2)
+  {
+    arr[m++] = arr[i];
+  }
+  qsort((void *)arr, m, sizeof(key_t), comp);
+  assert(idx_rbtree_sync(t) == 0);
+  delete_idx_rbtree(t);
+
+  // 다시 열면 읽어 들이지 않고 바로 같은 트리
+  idx_rbtree *r1 = idx_rbtree_open(path, 1);
+  idx_rbtree *r2 = idx_rbtree_open(path, 1);
+  assert(r1 != NULL && r2 != NULL);
+  assert(idx_black_height(r1->img->nodes, r1->img->root) >= 0);
+  key_t *res = calloc(n, sizeof(key_t));
+  assert(idx_rbtree_to_array(r1, res, m) == 0);
+  for (size_t i = 0; i < m; i++)
+  {
+    assert(res[i] == arr[i]);
+    assert(idx_rbtree_find(r2, arr[i]) != IDX_RBTREE_NIL);
+  }
+  assert(idx_rbtree_insert(r1, 1) == IDX_RBTREE_NIL);
+  assert(idx_rbtree_erase(r1, idx_rbtree_find(r1, arr[0])) == -1);
+  delete_idx_rbtree(r2);
+
+  // 쓰기로 다시 열어서 계속 수정 가능, 읽기 전용으로 열어 둔 쪽에서도 보임 (같은 페이지를 공유)
+  t = idx_rbtree_open(path, 0);
+  assert(t != NULL);
+  assert(idx_rbtree_open(path, 0) == NULL); // 쓰는 쪽은 하나만
+  assert(idx_rbtree_insert(t, -1) != IDX_RBTREE_NIL);
+  assert(idx_rbtree_find(r1, -1) != IDX_RBTREE_NIL);
+  assert(r1->img->nodes[idx_rbtree_min(r1)].key == -1);
+
+  // 쓰는 쪽이 파일을 늘리면 읽는 쪽은 다음 연산에서 다시 매핑
+  size_t old_size = r1->map_size;
+  for (size_t i = 0; i < n; i++)
+  {
+    assert(idx_rbtree_insert(t, (key_t)(n + i)) != IDX_RBTREE_NIL);
+  }
+  assert(idx_rbtree_sync(t) == 0);
+  assert(t->map_size > old_size);
+  for (size_t i = 0; i < n; i += 7)
+  {
+    assert(idx_rbtree_find(r1, (key_t)(n + i)) != IDX_RBTREE_NIL);
+  }
+  assert(r1->map_size == t->map_size);
+  assert(r1->img->nodes[idx_rbtree_max(r1)].key == (key_t)(2 * n - 1));
+  delete_idx_rbtree(r1);
+  delete_idx_rbtree(t);
+
+  // free_list가 범위를 벗어난 파일은 거부
+  uint32_t bad = UINT32_MAX;
+  fd = open(path, O_WRONLY);
+  assert(fd >= 0);
+  assert(pwrite(fd, &bad, sizeof(bad), sizeof(idx_rbtree_file_header) + offsetof(idx_rbtree_image, free_list)) ==
+         (ssize_t)sizeof(bad));
+  close(fd);
+  assert(idx_rbtree_open(path, 1) == NULL);
+
+  // 형식이 다른 파일은 거부
+  fd = open(path, O_WRONLY);
+  assert(fd >= 0);
+  assert(pwrite(fd, "garbage", 7, 0) == 7);
+  close(fd);
+  assert(idx_rbtree_open(path, 0) == NULL);
+  assert(idx_rbtree_open(path, 1) == NULL);
+  unlink(path);
+  assert(idx_rbtree_open(path, 1) == NULL); // 없는 파일
+
+  free(res);
+  free(arr);
+}
+
+// rbtree_stats의 모양 정보는 항상, 카운터는 RBTREE_STATS일 때만 실제 연산 수와 맞아야 함
+void test_stats(const size_t n, const unsigned int seed)
+{
+  srand(seed);
+  rbtree *t = new_rbtree();
+  rbtree_stats_t st;
+  assert(rbtree_stats(t, NULL) == -1);
+  assert(rbtree_stats(t, &st) == 0);
+  assert(st.nodes == 0 && st.height == 0 && st.black_height == 0);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_insert(t, (key_t)i); // 오름차순 삽입은 회전이 많이 일어남
+  }
+  for (size_t i = 0; i < n; i++)
+  {
+    rbtree_find(t, (key_t)(rand() % (2 * n)));
+  }
+  for (size_t i = 0; i < n / 2; i++)
+  {
+    assert(rbtree_erase_key(t, (key_t)(2 * i)) == 0);
+  }
+
+  assert(rbtree_stats(t, &st) == 0);
+  assert(st.nodes == n - n / 2);
+  assert(st.depth_hist[0] == 1);
+  size_t sum = 0, deepest = 0;
+  for (size_t d = 0; d < RBTREE_STATS_MAX_DEPTH; d++)
+  {
+    sum += st.depth_hist[d];
+    deepest = st.depth_hist[d] > 0 ? d : deepest;
+  }
+  assert(sum == st.nodes);
+  assert(st.height == deepest + 1);
+  assert(st.black_height >= 1 && st.height <= 2 * st.black_height);
+
+#ifdef RBTREE_STATS
+  assert(st.inserts == n);
+  assert(st.finds == n);
+  assert(st.find_compares >= st.finds);
+  assert(st.insert_compares >= n - 1);
+  assert(st.left_rotations > 0);
+  assert(st.insert_fixup_loops > 0 && st.delete_fixup_loops > 0);
+  assert(st.allocs == n);
+  assert(st.frees == n / 2);
+
+  // 카운터는 풀을 공유하는 트리끼리 합쳐서 셈
+  rbtree *u = new_rbtree_shared(t);
+  key_t key = 1;
+  rbtree_insert(u, key);
+  assert(rbtree_find_batch(u, &key, 1, (node_t *[1]){NULL}) == 1);
+  rbtree_stats_t su;
+  assert(rbtree_stats(t, &su) == 0);
+  assert(su.inserts == n + 1 && su.finds == n + 1 && su.allocs == n + 1);
+  assert(su.nodes == st.nodes);
+  delete_rbtree(u);
+#else
+  assert(st.inserts == 0 && st.finds == 0 && st.allocs == 0 && st.left_rotations == 0);
+#endif
+  delete_rbtree(t);
+}
+
+// erase된 노드는 풀의 free list를 통해 다음 insert에서 재사용되어야 함
+void test_pool_reuse(void)
+{
+#ifndef RBTREE_NO_POOL
+  rbtree *t = new_rbtree();
+  assert(t != NULL);
+
+  node_t *p = rbtree_insert(t, 10);
+  rbtree_insert(t, 20);
+  rbtree_erase(t, p);
+
+  node_t *q = rbtree_insert(t, 30);
+  assert(q == p);
+  assert(q->key == 30);
+  assert(rbtree_find(t, 10) == NULL);
+
+  delete_rbtree(t);
+#endif
+}
+
+int main(void)
+{
+  test_init();
+  test_insert_single(1024);
+  test_find_single(512, 1024);
+  test_erase_root(128);
+  test_find_erase_fixed();
+  test_minmax_suite();
+  test_pop_minmax(1000, 29);
+  test_insert_hint(2000, 31);
+  test_insert_batch_suite();
+  test_to_array_suite();
+  test_to_array_partial();
+  test_cursor(1000, 3);
+  test_bounds_range(500, 5);
+  test_find_batch(2000, 73);
+  test_frozen_suite();
+  test_distinct_values();
+  test_duplicate_values();
+  test_multi_instance();
+  test_find_erase_rand(10000, 17);
+  test_pool_reuse();
+  test_from_sorted_suite();
+  test_split_join(3000, 43);
+  test_erase_range(3000, 71);
+  test_compact(3000, 79);
+  test_stats(3000, 83);
+  test_snapshot(300000, 89);
+  test_set_ops_suite();
+  test_parallel(100, 61);
+  test_parallel(100000, 61);
+#ifdef RBTREE_MULTISET
+  test_multiset(2000, 67);
+#endif
+  test_template(1000, 13);
+  test_intrusive(1000, 19);
+  test_idx_tree(5000, 23);
+  test_idx_file(200000, 97);
+#ifdef RBTREE_ORDER_STAT
+  test_order_stat(2000, 11);
+#endif
   printf("Passed all tests!\n");
 }
\ No newline at end of file